@@ -2,7 +2,7 @@
 
 namespace Debug
 {
-	void Print(const FString& Message, const FColor& Color = FColor::MakeRandomColor(), int32 InKey = -1)
+	inline void Print(const FString& Message, const FColor& Color = FColor::MakeRandomColor(), int32 InKey = -1)
 	{
 		if (GEngine)
 		{
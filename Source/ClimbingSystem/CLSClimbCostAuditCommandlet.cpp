@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CLSClimbCostAuditCommandlet.h"
+#include "CLSMovementComponent.h"
+#include "ClimbingSystem.h"
+#include "GameFramework/Character.h"
+#include "ClimbingSystemGameMode.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Chaos/TriangleMeshImplicitObject.h"
+#include "EngineUtils.h"
+#include "Misc/FileHelper.h"
+#include "WorldPartition/WorldPartition.h"
+#if WITH_EDITOR
+#include "WorldPartition/LoaderAdapter/LoaderAdapterShape.h"
+#endif
+
+UCLSClimbCostAuditCommandlet::UCLSClimbCostAuditCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UCLSClimbCostAuditCommandlet::Main(const FString& Params)
+{
+	FString mapPath;
+	if (!FParse::Value(*Params, TEXT("Map="), mapPath))
+	{
+		UE_LOG(LogClimbingSystem, Error, TEXT("ClimbCostAudit: -Map= is required"));
+		return 1;
+	}
+
+	int32 numSamples {32};
+	FParse::Value(*Params, TEXT("Samples="), numSamples);
+	numSamples = FMath::Max(numSamples, 1);
+
+	float regionSize {25600.f};
+	FParse::Value(*Params, TEXT("RegionSize="), regionSize);
+
+	//trace shapes and filter come from the character climbers use, project default pawn otherwise
+	const UClass* characterClass {nullptr};
+	FString characterPath;
+	if (FParse::Value(*Params, TEXT("Character="), characterPath))
+	{
+		characterClass = LoadClass<ACharacter>(nullptr, *characterPath);
+	}
+	else
+	{
+		characterClass = GetDefault<AClimbingSystemGameMode>()->DefaultPawnClass;
+		characterPath = GetPathNameSafe(characterClass);
+	}
+
+	const ACharacter* characterDefaults {characterClass ? Cast<ACharacter>(characterClass->GetDefaultObject()) : nullptr};
+	const UCLSMovementComponent* climbMovement {characterDefaults ? Cast<UCLSMovementComponent>(characterDefaults->GetCharacterMovement()) : nullptr};
+	if (climbMovement == nullptr)
+	{
+		UE_LOG(LogClimbingSystem, Error, TEXT("ClimbCostAudit: %s is not a character with climb movement, pass one with -Character="), *characterPath);
+		return 1;
+	}
+
+	//empty filter would filter out every primitive and report nothing
+	if (!climbMovement->HasClimbQueryFilter())
+	{
+		UE_LOG(LogClimbingSystem, Error, TEXT("ClimbCostAudit: %s has no climb surface types, nothing can be climbed"), *characterPath);
+		return 1;
+	}
+
+	UPackage* mapPackage {LoadPackage(nullptr, *mapPath, LOAD_None)};
+	UWorld* world {mapPackage ? UWorld::FindWorldInPackage(mapPackage) : nullptr};
+	if (world == nullptr)
+	{
+		UE_LOG(LogClimbingSystem, Error, TEXT("ClimbCostAudit: failed to load map %s"), *mapPath);
+		return 1;
+	}
+
+	world->WorldType = EWorldType::Editor;
+	world->AddToRoot();
+	if (!world->bIsWorldInitialized)
+	{
+		world->InitWorld(UWorld::InitializationValues()
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(true)
+			.RequiresHitProxies(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.SetTransactional(false));
+	}
+
+	FWorldContext& worldContext {GEngine->CreateNewWorldContext(EWorldType::Editor)};
+	worldContext.SetCurrentWorld(world);
+	world->UpdateWorldComponents(true, true);
+
+	UWorldPartition* worldPartition {world->GetWorldPartition()};
+	if (worldPartition == nullptr)
+	{
+		AuditLoadedPrimitives(world, climbMovement, numSamples);
+	}
+#if WITH_EDITOR
+	else
+	{
+		if (!worldPartition->IsInitialized())
+		{
+			worldPartition->Initialize(world, FTransform::Identity);
+		}
+
+		//load the map region by region so memory stays bounded on large worlds
+		const FBox worldBounds {worldPartition->GetEditorWorldBounds()};
+		for (double x = worldBounds.Min.X; x < worldBounds.Max.X; x += regionSize)
+		{
+			for (double y = worldBounds.Min.Y; y < worldBounds.Max.Y; y += regionSize)
+			{
+				const FBox regionBounds {FVector {x, y, worldBounds.Min.Z}, FVector {x + regionSize, y + regionSize, worldBounds.Max.Z}};
+
+				FLoaderAdapterShape regionLoader {world, regionBounds, TEXT("Climb Cost Audit")};
+				regionLoader.Load();
+				AuditLoadedPrimitives(world, climbMovement, numSamples);
+				regionLoader.Unload();
+
+				CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+			}
+		}
+
+		worldPartition->Uninitialize();
+	}
+#endif
+
+	const bool bWritten {WriteReport(FPackageName::GetShortName(mapPath))};
+
+	GEngine->DestroyWorldContext(world);
+	world->DestroyWorld(false);
+	world->RemoveFromRoot();
+
+	return bWritten ? 0 : 1;
+}
+
+void UCLSClimbCostAuditCommandlet::AuditLoadedPrimitives(UWorld* World, const UCLSMovementComponent* ClimbMovement, int32 NumSamples)
+{
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		It->ForEachComponent<UPrimitiveComponent>(false, [this, ClimbMovement, NumSamples](UPrimitiveComponent* primitive)
+		{
+			if (!ClimbMovement->CanClimbPrimitive(primitive) || !primitive->IsPhysicsStateCreated())
+			{
+				return;
+			}
+
+			//primitives on region borders are loaded more than once
+			bool bAlreadyAudited {false};
+			AuditedPrimitives.Add(primitive->GetPathName(), &bAlreadyAudited);
+			if (!bAlreadyAudited)
+			{
+				PrimitiveCosts.Add(MeasurePrimitive(primitive, ClimbMovement, NumSamples));
+			}
+		});
+	}
+}
+
+UCLSClimbCostAuditCommandlet::FPrimitiveCost UCLSClimbCostAuditCommandlet::MeasurePrimitive(UPrimitiveComponent* Primitive, const UCLSMovementComponent* ClimbMovement, int32 NumSamples) const
+{
+	FPrimitiveCost cost;
+	cost.ActorName = Primitive->GetOwner() ? Primitive->GetOwner()->GetActorNameOrLabel() : FString {};
+	cost.ComponentName = Primitive->GetName();
+	cost.Location = Primitive->Bounds.Origin;
+
+	if (const UBodySetup* bodySetup {Primitive->GetBodySetup()})
+	{
+		static const TCHAR* TraceFlagNames[] {TEXT("Default"), TEXT("SimpleAndComplex"), TEXT("SimpleAsComplex"), TEXT("ComplexAsSimple")};
+		cost.CollisionComplexity = TraceFlagNames[FMath::Clamp((int32)bodySetup->GetCollisionTraceFlag(), 0, 3)];
+		cost.SimpleShapes = bodySetup->AggGeom.GetElementCount();
+
+		for (const FKConvexElem& convexElem : bodySetup->AggGeom.ConvexElems)
+		{
+			cost.ConvexVertices += convexElem.VertexData.Num();
+		}
+
+		//cooked collision triangles, they can differ a lot from render mesh
+		for (const auto& triMesh : bodySetup->TriMeshGeometries)
+		{
+			if (triMesh.IsValid())
+			{
+				cost.Triangles += triMesh->Elements().GetNumTriangles();
+			}
+		}
+	}
+	else
+	{
+		cost.CollisionComplexity = TEXT("None");
+	}
+
+	if (const UStaticMeshComponent* staticMeshComponent {Cast<UStaticMeshComponent>(Primitive)})
+	{
+		if (const UStaticMesh* staticMesh {staticMeshComponent->GetStaticMesh()})
+		{
+			cost.MeshName = staticMesh->GetPathName();
+		}
+	}
+
+	//same capsule TraceClimbSurfaces uses, swept towards the primitive from evenly spread directions
+	const FCollisionShape climbShape {FCollisionShape::MakeCapsule(ClimbMovement->GetClimbCapsuleTraceRadius(), ClimbMovement->GetClimbCapsuleTraceHalfHeight())};
+	const FVector boundsCenter {Primitive->Bounds.Origin};
+	const float sweepDistance {Primitive->Bounds.SphereRadius + ClimbMovement->GetClimbCapsuleTraceHalfHeight() * 2.f};
+	FRandomStream sampleStream {GetTypeHash(Primitive->GetPathName())};
+
+	uint64 sweepCycles {0};
+	uint64 penetrationCycles {0};
+	for (int32 sample = 0; sample < NumSamples; ++sample)
+	{
+		const FVector sweepStart {boundsCenter + sampleStream.GetUnitVector() * sweepDistance};
+
+		FHitResult sweepHit;
+		const uint64 sweepStartCycles {FPlatformTime::Cycles64()};
+		Primitive->SweepComponent(sweepHit, sweepStart, boundsCenter, FQuat::Identity, climbShape, false);
+		sweepCycles += FPlatformTime::Cycles64() - sweepStartCycles;
+
+		//contact query overlaps the capsule slightly into the surface
+		const FVector overlapLocation {sweepHit.bBlockingHit ? sweepHit.Location + (boundsCenter - sweepStart).GetSafeNormal() * ClimbMovement->GetClimbCapsuleTraceRadius() * 0.25f : boundsCenter};
+
+		FMTDResult mtdResult;
+		const uint64 penetrationStartCycles {FPlatformTime::Cycles64()};
+		Primitive->ComputePenetration(mtdResult, climbShape, overlapLocation, FQuat::Identity);
+		penetrationCycles += FPlatformTime::Cycles64() - penetrationStartCycles;
+	}
+
+	cost.AvgSweepMicroseconds = FPlatformTime::ToMilliseconds64(sweepCycles) * 1000.0 / NumSamples;
+	cost.AvgPenetrationMicroseconds = FPlatformTime::ToMilliseconds64(penetrationCycles) * 1000.0 / NumSamples;
+
+	return cost;
+}
+
+bool UCLSClimbCostAuditCommandlet::WriteReport(const FString& MapName) const
+{
+	TArray<FPrimitiveCost> rankedCosts {PrimitiveCosts};
+	rankedCosts.Sort([](const FPrimitiveCost& A, const FPrimitiveCost& B)
+	{
+		return A.AvgSweepMicroseconds + A.AvgPenetrationMicroseconds > B.AvgSweepMicroseconds + B.AvgPenetrationMicroseconds;
+	});
+
+	TArray<FString> lines;
+	lines.Reserve(rankedCosts.Num() + 1);
+	lines.Add(TEXT("Rank,Actor,Component,Mesh,Collision,SimpleShapes,ConvexVertices,CollisionTriangles,AvgSweepUs,AvgPenetrationUs,X,Y,Z"));
+
+	for (int32 rank = 0; rank < rankedCosts.Num(); ++rank)
+	{
+		const FPrimitiveCost& cost {rankedCosts[rank]};
+		lines.Add(FString::Printf(TEXT("%d,%s,%s,%s,%s,%d,%d,%d,%.3f,%.3f,%.0f,%.0f,%.0f"), rank + 1,
+			*EscapeCsvField(cost.ActorName), *EscapeCsvField(cost.ComponentName), *EscapeCsvField(cost.MeshName), *cost.CollisionComplexity,
+			cost.SimpleShapes, cost.ConvexVertices, cost.Triangles, cost.AvgSweepMicroseconds, cost.AvgPenetrationMicroseconds,
+			cost.Location.X, cost.Location.Y, cost.Location.Z));
+	}
+
+	const FString reportPath {FPaths::ProjectSavedDir() / TEXT("ClimbAudit") / FString::Printf(TEXT("%s_%s.csv"), *MapName, *FDateTime::Now().ToString())};
+	if (!FFileHelper::SaveStringArrayToFile(lines, *reportPath))
+	{
+		UE_LOG(LogClimbingSystem, Error, TEXT("ClimbCostAudit: failed to write %s"), *reportPath);
+		return false;
+	}
+
+	UE_LOG(LogClimbingSystem, Display, TEXT("ClimbCostAudit: %d climbable primitives written to %s"), rankedCosts.Num(), *reportPath);
+	return true;
+}
+
+FString UCLSClimbCostAuditCommandlet::EscapeCsvField(const FString& Field)
+{
+	return FString::Printf(TEXT("\"%s\""), *Field.Replace(TEXT("\""), TEXT("\"\"")));
+}
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "CLSClimbCostAuditCommandlet.generated.h"
+
+class UCLSMovementComponent;
+
+/**
+ * Scans a level for primitives climbers can hit and ranks them by climb query cost.
+ * Reports collision complexity and triangle counts, times sweeps and penetration tests with the project climb capsule
+ * and writes a csv to Saved/ClimbAudit.
+ *
+ * Usage: UnrealEditor-Cmd ClimbingSystem.uproject -run=CLSClimbCostAudit -Map=/Game/ThirdPerson/Maps/ThirdPersonMap
+ *        [-Character=/Game/ThirdPerson/Blueprints/BP_ThirdPersonCharacter.BP_ThirdPersonCharacter_C, game mode default pawn if omitted] [-Samples=32] [-RegionSize=25600]
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UCLSClimbCostAuditCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UCLSClimbCostAuditCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FPrimitiveCost
+	{
+		FString ActorName;
+		FString ComponentName;
+		FString MeshName;
+		FString CollisionComplexity;
+		int32 SimpleShapes {0};
+		int32 ConvexVertices {0};
+		//triangles of complex collision, what traces against the mesh actually test
+		int32 Triangles {0};
+		double AvgSweepMicroseconds {0.0};
+		double AvgPenetrationMicroseconds {0.0};
+		FVector Location {FVector::ZeroVector};
+	};
+
+	//measures all climbable primitives of currently loaded actors, skips already audited ones
+	void AuditLoadedPrimitives(UWorld* World, const UCLSMovementComponent* ClimbMovement, int32 NumSamples);
+
+	FPrimitiveCost MeasurePrimitive(UPrimitiveComponent* Primitive, const UCLSMovementComponent* ClimbMovement, int32 NumSamples) const;
+
+	bool WriteReport(const FString& MapName) const;
+
+	//quotes CSV field, names may contain commas and quotes
+	static FString EscapeCsvField(const FString& Field);
+
+	TArray<FPrimitiveCost> PrimitiveCosts;
+	TSet<FString> AuditedPrimitives;
+};
@@ -0,0 +1,286 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CLSClimbDataActor.h"
+#include "CLSClimbDataSubsystem.h"
+#include "ClimbingSystem.h"
+#include "Components/SceneComponent.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "EngineUtils.h"
+
+FVector FClimbDataSurface::GetClosestPoint(const FVector& Location) const
+{
+	const FVector localLocation {Location - Center};
+	const float rightOffset {FMath::Clamp((float)FVector::DotProduct(localLocation, Right), (float)-HalfExtents.X, (float)HalfExtents.X)};
+	const float upOffset {FMath::Clamp((float)FVector::DotProduct(localLocation, Up), (float)-HalfExtents.Y, (float)HalfExtents.Y)};
+
+	return Center + Right * rightOffset + Up * upOffset;
+}
+
+FBox FClimbDataSurface::GetBounds() const
+{
+	const FVector extent {Right.GetAbs() * HalfExtents.X + Up.GetAbs() * HalfExtents.Y};
+	return FBox::BuildAABB(Center, extent);
+}
+
+FBox FClimbDataVault::GetBounds() const
+{
+	FBox bounds {ForceInit};
+	bounds += EdgeStart;
+	bounds += EdgeEnd;
+	bounds += EdgeStart + Depth;
+	bounds += EdgeEnd + Depth;
+	return bounds;
+}
+
+ACLSClimbDataActor::ACLSClimbDataActor()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	SetCanBeDamaged(false);
+	SetActorHiddenInGame(true);
+
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+	RootComponent->SetMobility(EComponentMobility::Static);
+
+#if WITH_EDITORONLY_DATA
+	//streams with the cell that contains actor location
+	bIsSpatiallyLoaded = true;
+	ClimbSurfaceTypes.Add(UEngineTypes::ConvertToObjectType(ECC_WorldStatic));
+#endif
+}
+
+SIZE_T ACLSClimbDataActor::GetClimbDataSize() const
+{
+	return Surfaces.GetAllocatedSize() + Ledges.GetAllocatedSize() + VaultSpans.GetAllocatedSize();
+}
+
+void ACLSClimbDataActor::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UCLSClimbDataSubsystem* climbDataSubsystem {GetWorld()->GetSubsystem<UCLSClimbDataSubsystem>()})
+	{
+		climbDataSubsystem->RegisterClimbData(this);
+	}
+}
+
+void ACLSClimbDataActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UCLSClimbDataSubsystem* climbDataSubsystem {GetWorld()->GetSubsystem<UCLSClimbDataSubsystem>()})
+	{
+		climbDataSubsystem->UnregisterClimbData(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+#if WITH_EDITOR
+
+void ACLSClimbDataActor::BuildClimbData()
+{
+	UWorld* world {GetWorld()};
+	if (world == nullptr)
+	{
+		return;
+	}
+
+	//data is only rebuilt here, so save picks it up as a regular edit
+	Modify();
+
+	Surfaces.Reset();
+	Ledges.Reset();
+	VaultSpans.Reset();
+	DataBounds.Init();
+
+	const FBox generationBox {FBox::BuildAABB(GetActorLocation(), GenerationExtent)};
+
+	//all boxes are gathered first so faces can be tested against their neighbours
+	TArray<FClimbDataBox> boxes;
+
+	for (TActorIterator<AActor> It(world); It; ++It)
+	{
+		if (*It == this)
+		{
+			continue;
+		}
+
+		It->ForEachComponent<UPrimitiveComponent>(false, [this, &generationBox, &boxes](const UPrimitiveComponent* primitive)
+		{
+			//only static geometry can be baked, everything else is found by physics fallback
+			if (primitive->Mobility != EComponentMobility::Static || !IsClimbablePrimitive(primitive) || !generationBox.Intersect(primitive->Bounds.GetBox()))
+			{
+				return;
+			}
+
+			const UBodySetup* bodySetup {primitive->GetBodySetup()};
+			if (bodySetup == nullptr)
+			{
+				return;
+			}
+
+			const FTransform& componentTransform {primitive->GetComponentTransform()};
+			for (const FKBoxElem& boxElem : bodySetup->AggGeom.BoxElems)
+			{
+				FClimbDataBox& box {boxes.AddDefaulted_GetRef()};
+				box.Transform = boxElem.GetTransform() * componentTransform;
+				box.HalfExtents = FVector {boxElem.X, boxElem.Y, boxElem.Z} * 0.5f * componentTransform.GetScale3D().GetAbs();
+				box.Component = primitive;
+			}
+		});
+	}
+
+	for (const FClimbDataBox& box : boxes)
+	{
+		AddBoxClimbData(box, boxes);
+	}
+
+	UE_LOG(LogClimbingSystem, Log, TEXT("%s: built %d climb surfaces, %d ledges, %d vault spans (%.1f KB)"),
+		*GetName(), Surfaces.Num(), Ledges.Num(), VaultSpans.Num(), GetClimbDataSize() / 1024.f);
+}
+
+bool ACLSClimbDataActor::IsClimbablePrimitive(const UPrimitiveComponent* Primitive) const
+{
+	if (!Primitive->IsQueryCollisionEnabled())
+	{
+		return false;
+	}
+
+	if (ClimbQueryFilter == EClimbQueryFilter::ClimbableChannel)
+	{
+		return Primitive->GetCollisionResponseToChannel(ECC_Climbable) == ECR_Block;
+	}
+
+	return ClimbSurfaceTypes.Contains(UEngineTypes::ConvertToObjectType(Primitive->GetCollisionObjectType()));
+}
+
+bool FClimbDataBox::ContainsPoint(const FVector& Point, float Tolerance) const
+{
+	const FVector localPoint {Transform.InverseTransformPositionNoScale(Point).GetAbs()};
+	return localPoint.X <= HalfExtents.X + Tolerance && localPoint.Y <= HalfExtents.Y + Tolerance && localPoint.Z <= HalfExtents.Z + Tolerance;
+}
+
+bool ACLSClimbDataActor::IsFaceCovered(const FClimbDataBox& Box, const FVector& FaceCenter, const FVector& FaceNormal, const FVector& FaceRight, const FVector& FaceUp, const FVector2D& FaceHalfExtents, TConstArrayView<FClimbDataBox> AllBoxes)
+{
+	constexpr float tolerance {1.f};
+
+	//center and slightly inset corners, partially covered faces are kept whole
+	const FVector2D insetHalfExtents {FaceHalfExtents * 0.95f};
+	const FVector facePoints[5]
+	{
+		FaceCenter,
+		FaceCenter + FaceRight * insetHalfExtents.X + FaceUp * insetHalfExtents.Y,
+		FaceCenter + FaceRight * insetHalfExtents.X - FaceUp * insetHalfExtents.Y,
+		FaceCenter - FaceRight * insetHalfExtents.X + FaceUp * insetHalfExtents.Y,
+		FaceCenter - FaceRight * insetHalfExtents.X - FaceUp * insetHalfExtents.Y
+	};
+
+	for (const FVector& facePoint : facePoints)
+	{
+		const FVector outsidePoint {facePoint + FaceNormal * tolerance};
+		const bool bInsideOtherBox {AllBoxes.ContainsByPredicate([&Box, &outsidePoint](const FClimbDataBox& OtherBox)
+		{
+			return &OtherBox != &Box && OtherBox.ContainsPoint(outsidePoint, tolerance);
+		})};
+
+		if (!bInsideOtherBox)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void ACLSClimbDataActor::AddBoxClimbData(const FClimbDataBox& Box, TConstArrayView<FClimbDataBox> AllBoxes)
+{
+	const FTransform& boxTransform {Box.Transform};
+	const FVector& boxHalfExtents {Box.HalfExtents};
+
+	const FVector boxCenter {boxTransform.GetLocation()};
+	const FVector boxAxes[3] {boxTransform.GetUnitAxis(EAxis::X), boxTransform.GetUnitAxis(EAxis::Y), boxTransform.GetUnitAxis(EAxis::Z)};
+
+	//box axis closest to world up, its positive side is the top
+	int32 topAxis {0};
+	for (int32 axis = 1; axis < 3; ++axis)
+	{
+		if (FMath::Abs(boxAxes[axis].Z) > FMath::Abs(boxAxes[topAxis].Z))
+		{
+			topAxis = axis;
+		}
+	}
+	const FVector topNormal {boxAxes[topAxis] * FMath::Sign(boxAxes[topAxis].Z)};
+
+	//no ledges under another box stacked on top
+	const int32 topRightAxis {(topAxis + 1) % 3};
+	const int32 topForwardAxis {(topAxis + 2) % 3};
+	const bool bWalkableTop {topNormal.Z >= 0.7f && !IsFaceCovered(Box, boxCenter + topNormal * boxHalfExtents[topAxis], topNormal,
+		boxAxes[topRightAxis], boxAxes[topForwardAxis], FVector2D {boxHalfExtents[topRightAxis], boxHalfExtents[topForwardAxis]}, AllBoxes)};
+
+	FBox boxBounds {ForceInit};
+	for (int32 corner = 0; corner < 8; ++corner)
+	{
+		const FVector cornerSign {(corner & 1) ? 1.f : -1.f, (corner & 2) ? 1.f : -1.f, (corner & 4) ? 1.f : -1.f};
+		boxBounds += boxTransform.TransformPositionNoScale(cornerSign * boxHalfExtents);
+	}
+	const float boxHeight {(float)boxBounds.GetSize().Z};
+
+	for (int32 axis = 0; axis < 3; ++axis)
+	{
+		if (axis == topAxis)
+		{
+			continue;
+		}
+
+		const int32 rightAxis {3 - axis - topAxis};
+
+		for (const float side : {-1.f, 1.f})
+		{
+			const FVector faceNormal {boxAxes[axis] * side};
+			if (FMath::Abs(faceNormal.Z) > MaxSurfaceNormalZ)
+			{
+				continue;
+			}
+
+			const FVector faceCenter {boxCenter + faceNormal * boxHalfExtents[axis]};
+			const FVector2D faceHalfExtents {boxHalfExtents[rightAxis], boxHalfExtents[topAxis]};
+			if (IsFaceCovered(Box, faceCenter, faceNormal, boxAxes[rightAxis], topNormal, faceHalfExtents, AllBoxes))
+			{
+				continue;
+			}
+
+			FClimbDataSurface& surface {Surfaces.AddDefaulted_GetRef()};
+			surface.Center = faceCenter;
+			surface.Normal = faceNormal;
+			surface.Right = boxAxes[rightAxis];
+			surface.Up = topNormal;
+			surface.HalfExtents = faceHalfExtents;
+			surface.Component = const_cast<UPrimitiveComponent*>(Box.Component);
+
+			if (!bWalkableTop)
+			{
+				continue;
+			}
+
+			const FVector edgeCenter {surface.Center + topNormal * boxHalfExtents[topAxis]};
+			const FVector edgeStart {edgeCenter - surface.Right * boxHalfExtents[rightAxis]};
+			const FVector edgeEnd {edgeCenter + surface.Right * boxHalfExtents[rightAxis]};
+			FClimbDataLedge& ledge {Ledges.AddDefaulted_GetRef()};
+			ledge.Start = edgeStart;
+			ledge.End = edgeEnd;
+			ledge.Normal = faceNormal;
+
+			const float boxDepth {2.f * (float)boxHalfExtents[axis]};
+			if (boxHeight <= MaxVaultHeight && boxDepth <= MaxVaultDepth)
+			{
+				FClimbDataVault& vaultSpan {VaultSpans.AddDefaulted_GetRef()};
+				vaultSpan.EdgeStart = edgeStart;
+				vaultSpan.EdgeEnd = edgeEnd;
+				vaultSpan.Depth = -faceNormal * boxDepth;
+				vaultSpan.FloorHeight = boxBounds.Min.Z;
+			}
+		}
+	}
+
+	DataBounds += boxBounds;
+}
+
+#endif
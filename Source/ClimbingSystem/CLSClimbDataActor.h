@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "CLSMovementComponent.h"
+#include "CLSClimbDataActor.generated.h"
+
+//Climbable rectangle, face of a climbable primitive simple collision box
+USTRUCT()
+struct FClimbDataSurface
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector Center {FVector::ZeroVector};
+
+	UPROPERTY()
+	FVector Normal {FVector::ZeroVector};
+
+	UPROPERTY()
+	FVector Right {FVector::ZeroVector};
+
+	UPROPERTY()
+	FVector Up {FVector::ZeroVector};
+
+	//half size along Right and Up
+	UPROPERTY()
+	FVector2D HalfExtents {FVector2D::ZeroVector};
+
+	//primitive the face was built from, contacts report it so climbing can track its base
+	UPROPERTY()
+	TSoftObjectPtr<UPrimitiveComponent> Component;
+
+	FVector GetClosestPoint(const FVector& Location) const;
+
+	FBox GetBounds() const;
+};
+
+//Top edge of a climbable face with walkable top
+USTRUCT()
+struct FClimbDataLedge
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector Start {FVector::ZeroVector};
+
+	UPROPERTY()
+	FVector End {FVector::ZeroVector};
+
+	//points out of the ledge
+	UPROPERTY()
+	FVector Normal {FVector::ZeroVector};
+};
+
+//Obstacle low and thin enough to vault over
+USTRUCT()
+struct FClimbDataVault
+{
+	GENERATED_BODY()
+
+	//near top edge of the obstacle
+	UPROPERTY()
+	FVector EdgeStart {FVector::ZeroVector};
+
+	UPROPERTY()
+	FVector EdgeEnd {FVector::ZeroVector};
+
+	//from near edge to the far side of the obstacle top
+	UPROPERTY()
+	FVector Depth {FVector::ZeroVector};
+
+	//bottom of the obstacle, landing height
+	UPROPERTY()
+	float FloorHeight {0.f};
+
+	FBox GetBounds() const;
+};
+
+#if WITH_EDITOR
+//Simple collision box of a climbable primitive, data is built from these
+struct FClimbDataBox
+{
+	FTransform Transform;
+	FVector HalfExtents {FVector::ZeroVector};
+	const UPrimitiveComponent* Component {nullptr};
+
+	bool ContainsPoint(const FVector& Point, float Tolerance) const;
+};
+#endif
+
+/**
+ * Precomputed climb data of one streaming cell. Spatially loaded, so with World Partition
+ * it streams in and out together with the cell it is placed in and registers itself in UCLSClimbDataSubsystem.
+ * Data is built from simple collision boxes of climbable static primitives inside GenerationExtent
+ * only on explicit BuildClimbData, saving with a partially loaded world keeps the last built data.
+ * Faces covered by other boxes are culled, so touching boxes don't produce contacts inside the geometry
+ */
+UCLASS(NotBlueprintable, HideCategories = (Rendering, Replication, Input, Actor, LOD, Cooking))
+class CLIMBINGSYSTEM_API ACLSClimbDataActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ACLSClimbDataActor();
+
+	FORCEINLINE const FBox& GetDataBounds() const {return DataBounds;};
+	FORCEINLINE const TArray<FClimbDataSurface>& GetSurfaces() const {return Surfaces;};
+	FORCEINLINE const TArray<FClimbDataLedge>& GetLedges() const {return Ledges;};
+	FORCEINLINE const TArray<FClimbDataVault>& GetVaultSpans() const {return VaultSpans;};
+
+	SIZE_T GetClimbDataSize() const;
+
+#if WITH_EDITOR
+	//Rebuilds data from the actors currently loaded in GenerationExtent, load the whole extent first
+	UFUNCTION(CallInEditor, category = "Climb Data")
+	void BuildClimbData();
+#endif
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+#if WITH_EDITOR
+	bool IsClimbablePrimitive(const UPrimitiveComponent* Primitive) const;
+	void AddBoxClimbData(const FClimbDataBox& Box, TConstArrayView<FClimbDataBox> AllBoxes);
+
+	//face is inside the geometry if points just outside of it are inside other boxes
+	static bool IsFaceCovered(const FClimbDataBox& Box, const FVector& FaceCenter, const FVector& FaceNormal, const FVector& FaceRight, const FVector& FaceUp, const FVector2D& FaceHalfExtents, TConstArrayView<FClimbDataBox> AllBoxes);
+#endif
+
+#if WITH_EDITORONLY_DATA
+	//Half size of the area data is built for, usually a streaming cell
+	UPROPERTY(EditAnywhere, category = "Climb Data")
+	FVector GenerationExtent {12800.f, 12800.f, 6400.f};
+
+	UPROPERTY(EditAnywhere, category = "Climb Data")
+	EClimbQueryFilter ClimbQueryFilter {EClimbQueryFilter::ObjectTypes};
+
+	UPROPERTY(EditAnywhere, category = "Climb Data")
+	TArray<TEnumAsByte<EObjectTypeQuery>> ClimbSurfaceTypes;
+
+	//Faces with normal Z above that are not climbable
+	UPROPERTY(EditAnywhere, category = "Climb Data")
+	float MaxSurfaceNormalZ {0.3f};
+
+	UPROPERTY(EditAnywhere, category = "Climb Data")
+	float MaxVaultHeight {150.f};
+
+	UPROPERTY(EditAnywhere, category = "Climb Data")
+	float MaxVaultDepth {300.f};
+#endif
+
+	UPROPERTY(VisibleAnywhere, category = "Climb Data")
+	FBox DataBounds {ForceInit};
+
+	UPROPERTY()
+	TArray<FClimbDataSurface> Surfaces;
+
+	UPROPERTY()
+	TArray<FClimbDataLedge> Ledges;
+
+	UPROPERTY()
+	TArray<FClimbDataVault> VaultSpans;
+};
@@ -0,0 +1,245 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CLSClimbDataSubsystem.h"
+#include "CLSClimbDataActor.h"
+
+void UCLSClimbDataSubsystem::RegisterClimbData(ACLSClimbDataActor* ClimbData)
+{
+	if (ClimbData == nullptr || LoadedClimbData.Contains(ClimbData))
+	{
+		return;
+	}
+
+	LoadedClimbData.Add(ClimbData);
+
+	const TArray<FClimbDataSurface>& surfaces {ClimbData->GetSurfaces()};
+	for (int32 i = 0; i < surfaces.Num(); ++i)
+	{
+		AddToCells(SurfaceCells, surfaces[i].GetBounds(), FClimbDataCellEntry {ClimbData, i});
+		if (!surfaces[i].Component.IsNull())
+		{
+			++BakedComponents.FindOrAdd(surfaces[i].Component.ToSoftObjectPath());
+		}
+	}
+
+	const TArray<FClimbDataVault>& vaultSpans {ClimbData->GetVaultSpans()};
+	for (int32 i = 0; i < vaultSpans.Num(); ++i)
+	{
+		AddToCells(VaultSpanCells, vaultSpans[i].GetBounds(), FClimbDataCellEntry {ClimbData, i});
+	}
+}
+
+void UCLSClimbDataSubsystem::UnregisterClimbData(ACLSClimbDataActor* ClimbData)
+{
+	if (ClimbData == nullptr || LoadedClimbData.RemoveSwap(ClimbData) == 0)
+	{
+		return;
+	}
+
+	const TArray<FClimbDataSurface>& surfaces {ClimbData->GetSurfaces()};
+	for (int32 i = 0; i < surfaces.Num(); ++i)
+	{
+		RemoveFromCells(SurfaceCells, surfaces[i].GetBounds(), FClimbDataCellEntry {ClimbData, i});
+
+		const FSoftObjectPath componentPath {surfaces[i].Component.ToSoftObjectPath()};
+		int32* bakedSurfaces {BakedComponents.Find(componentPath)};
+		if (bakedSurfaces != nullptr && --(*bakedSurfaces) <= 0)
+		{
+			BakedComponents.Remove(componentPath);
+		}
+	}
+
+	const TArray<FClimbDataVault>& vaultSpans {ClimbData->GetVaultSpans()};
+	for (int32 i = 0; i < vaultSpans.Num(); ++i)
+	{
+		RemoveFromCells(VaultSpanCells, vaultSpans[i].GetBounds(), FClimbDataCellEntry {ClimbData, i});
+	}
+}
+
+bool UCLSClimbDataSubsystem::FindClimbContacts(const FVector& Location, float Radius, float HalfHeight, TArray<FClimbContact>& OutContacts) const
+{
+	OutContacts.Reset();
+
+	const FBox queryBox {FBox::BuildAABB(Location, FVector {Radius, Radius, HalfHeight})};
+	const FVector segmentOffset {FVector::UpVector * FMath::Max(0.f, HalfHeight - Radius)};
+
+	TArray<FClimbDataCellEntry, TInlineAllocator<32>> entries;
+	GatherCellEntries(SurfaceCells, queryBox, entries);
+
+	for (const FClimbDataCellEntry& entry : entries)
+	{
+		const FClimbDataSurface& surface {entry.ClimbData->GetSurfaces()[entry.Index]};
+
+		//only surfaces facing the capsule
+		if (FVector::DotProduct(Location - surface.Center, surface.Normal) <= 0.f)
+		{
+			continue;
+		}
+
+		const FVector surfacePoint {surface.GetClosestPoint(Location)};
+		const FVector capsulePoint {FMath::ClosestPointOnSegment(surfacePoint, Location - segmentOffset, Location + segmentOffset)};
+		const float distance {(float)FVector::Dist(surfacePoint, capsulePoint)};
+
+		if (distance > Radius)
+		{
+			continue;
+		}
+
+		FClimbContact& contact {OutContacts.AddDefaulted_GetRef()};
+		contact.Location = surfacePoint;
+		contact.Normal = surface.Normal;
+		contact.PenetrationDepth = Radius - distance;
+		contact.Component = surface.Component.Get();
+	}
+
+	return !OutContacts.IsEmpty();
+}
+
+bool UCLSClimbDataSubsystem::IsBakedComponent(const UPrimitiveComponent* Component) const
+{
+	return Component != nullptr && !BakedComponents.IsEmpty() && BakedComponents.Contains(FSoftObjectPath(Component));
+}
+
+bool UCLSClimbDataSubsystem::FindVaultSpan(const FVector& Location, const FVector& Forward, float MaxDistance, float MinEdgeHeight, float MaxEdgeHeight, FVector& OutStart, FVector& OutEnd) const
+{
+	const FVector horizontalForward {FVector::VectorPlaneProject(Forward, FVector::UpVector).GetSafeNormal()};
+	const FBox queryBox {FVector {Location.X - MaxDistance, Location.Y - MaxDistance, Location.Z + MinEdgeHeight},
+		FVector {Location.X + MaxDistance, Location.Y + MaxDistance, Location.Z + MaxEdgeHeight}};
+
+	TArray<FClimbDataCellEntry, TInlineAllocator<32>> entries;
+	GatherCellEntries(VaultSpanCells, queryBox, entries);
+
+	float bestDistance {MaxDistance};
+	bool bFound {false};
+
+	for (const FClimbDataCellEntry& entry : entries)
+	{
+		const FClimbDataVault& vaultSpan {entry.ClimbData->GetVaultSpans()[entry.Index]};
+
+		const FVector vaultDirection {vaultSpan.Depth.GetSafeNormal()};
+		if (FVector::DotProduct(vaultDirection, horizontalForward) < 0.7f)
+		{
+			continue;
+		}
+
+		const FVector edgePoint {FMath::ClosestPointOnSegment(FVector {Location.X, Location.Y, vaultSpan.EdgeStart.Z}, vaultSpan.EdgeStart, vaultSpan.EdgeEnd)};
+
+		//obstacle top on another floor
+		const float edgeHeight {(float)(edgePoint.Z - Location.Z)};
+		if (edgeHeight < MinEdgeHeight || edgeHeight > MaxEdgeHeight)
+		{
+			continue;
+		}
+
+		const FVector toEdge {FVector::VectorPlaneProject(edgePoint - Location, FVector::UpVector)};
+		const float distance {(float)toEdge.Size()};
+
+		if (distance >= bestDistance || FVector::DotProduct(toEdge, vaultDirection) <= 0.f)
+		{
+			continue;
+		}
+
+		//land a bit behind the obstacle
+		bestDistance = distance;
+		bFound = true;
+		OutStart = edgePoint;
+		OutEnd = edgePoint + vaultSpan.Depth + vaultDirection * 50.f;
+		OutEnd.Z = vaultSpan.FloorHeight;
+	}
+
+	return bFound;
+}
+
+SIZE_T UCLSClimbDataSubsystem::GetLoadedClimbDataSize() const
+{
+	SIZE_T dataSize {LoadedClimbData.GetAllocatedSize() + SurfaceCells.GetAllocatedSize() + VaultSpanCells.GetAllocatedSize() + BakedComponents.GetAllocatedSize()};
+	for (const TWeakObjectPtr<ACLSClimbDataActor>& weakClimbData : LoadedClimbData)
+	{
+		if (const ACLSClimbDataActor* climbData {weakClimbData.Get()})
+		{
+			dataSize += climbData->GetClimbDataSize();
+		}
+	}
+	for (const FClimbDataCells* cells : {&SurfaceCells, &VaultSpanCells})
+	{
+		for (const TPair<FIntVector, TArray<FClimbDataCellEntry>>& cell : *cells)
+		{
+			dataSize += cell.Value.GetAllocatedSize();
+		}
+	}
+	return dataSize;
+}
+
+FIntVector UCLSClimbDataSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector {FMath::FloorToInt32(Location.X / CellSize), FMath::FloorToInt32(Location.Y / CellSize), FMath::FloorToInt32(Location.Z / CellSize)};
+}
+
+void UCLSClimbDataSubsystem::AddToCells(FClimbDataCells& Cells, const FBox& Bounds, const FClimbDataCellEntry& Entry)
+{
+	const FIntVector minCell {GetCell(Bounds.Min)};
+	const FIntVector maxCell {GetCell(Bounds.Max)};
+
+	for (int32 x = minCell.X; x <= maxCell.X; ++x)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+		{
+			for (int32 z = minCell.Z; z <= maxCell.Z; ++z)
+			{
+				Cells.FindOrAdd(FIntVector {x, y, z}).Add(Entry);
+			}
+		}
+	}
+}
+
+void UCLSClimbDataSubsystem::RemoveFromCells(FClimbDataCells& Cells, const FBox& Bounds, const FClimbDataCellEntry& Entry)
+{
+	const FIntVector minCell {GetCell(Bounds.Min)};
+	const FIntVector maxCell {GetCell(Bounds.Max)};
+
+	for (int32 x = minCell.X; x <= maxCell.X; ++x)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+		{
+			for (int32 z = minCell.Z; z <= maxCell.Z; ++z)
+			{
+				const FIntVector cell {x, y, z};
+				if (TArray<FClimbDataCellEntry>* cellEntries {Cells.Find(cell)})
+				{
+					cellEntries->RemoveSwap(Entry);
+					if (cellEntries->IsEmpty())
+					{
+						Cells.Remove(cell);
+					}
+				}
+			}
+		}
+	}
+}
+
+void UCLSClimbDataSubsystem::GatherCellEntries(const FClimbDataCells& Cells, const FBox& QueryBox, TArray<FClimbDataCellEntry, TInlineAllocator<32>>& OutEntries) const
+{
+	const FIntVector minCell {GetCell(QueryBox.Min)};
+	const FIntVector maxCell {GetCell(QueryBox.Max)};
+
+	for (int32 x = minCell.X; x <= maxCell.X; ++x)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+		{
+			for (int32 z = minCell.Z; z <= maxCell.Z; ++z)
+			{
+				const TArray<FClimbDataCellEntry>* cellEntries {Cells.Find(FIntVector {x, y, z})};
+				if (cellEntries == nullptr)
+				{
+					continue;
+				}
+
+				//large surfaces are in several cells
+				for (const FClimbDataCellEntry& entry : *cellEntries)
+				{
+					OutEntries.AddUnique(entry);
+				}
+			}
+		}
+	}
+}
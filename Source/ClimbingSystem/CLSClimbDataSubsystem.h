@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CLSClimbDataSubsystem.generated.h"
+
+class ACLSClimbDataActor;
+struct FClimbContact;
+
+/**
+ * Keeps climb data of currently loaded streaming cells and answers climb queries from it.
+ * Memory is owned by the data actors, so it is bounded by the set of loaded cells
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UCLSClimbDataSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterClimbData(ACLSClimbDataActor* ClimbData);
+	void UnregisterClimbData(ACLSClimbDataActor* ClimbData);
+
+	//contacts between a vertical capsule and baked climb surfaces
+	bool FindClimbContacts(const FVector& Location, float Radius, float HalfHeight, TArray<FClimbContact>& OutContacts) const;
+
+	/*
+		Closest vault span in front of the location. OutStart is on obstacle top, OutEnd is on the floor behind it.
+		Obstacle top has to be between MinEdgeHeight and MaxEdgeHeight above the location, spans on other floors are skipped
+	*/
+	bool FindVaultSpan(const FVector& Location, const FVector& Forward, float MaxDistance, float MinEdgeHeight, float MaxEdgeHeight, FVector& OutStart, FVector& OutEnd) const;
+
+	FORCEINLINE bool HasClimbData() const {return !LoadedClimbData.IsEmpty();};
+
+	//true if surfaces of the primitive are in loaded data, physics queries can skip it
+	bool IsBakedComponent(const UPrimitiveComponent* Component) const;
+
+	SIZE_T GetLoadedClimbDataSize() const;
+
+private:
+	//one surface or vault span of a loaded data actor
+	struct FClimbDataCellEntry
+	{
+		const ACLSClimbDataActor* ClimbData {nullptr};
+		int32 Index {INDEX_NONE};
+
+		bool operator==(const FClimbDataCellEntry& Other) const {return ClimbData == Other.ClimbData && Index == Other.Index;};
+	};
+
+	using FClimbDataCells = TMap<FIntVector, TArray<FClimbDataCellEntry>>;
+
+	FIntVector GetCell(const FVector& Location) const;
+
+	void AddToCells(FClimbDataCells& Cells, const FBox& Bounds, const FClimbDataCellEntry& Entry);
+	void RemoveFromCells(FClimbDataCells& Cells, const FBox& Bounds, const FClimbDataCellEntry& Entry);
+
+	//entries of all cells the box touches, each entry once
+	void GatherCellEntries(const FClimbDataCells& Cells, const FBox& QueryBox, TArray<FClimbDataCellEntry, TInlineAllocator<32>>& OutEntries) const;
+
+	//cell is smaller than a streaming cell so a query only looks at data next to it
+	static constexpr float CellSize {400.f};
+
+	TArray<TWeakObjectPtr<ACLSClimbDataActor>> LoadedClimbData;
+
+	FClimbDataCells SurfaceCells;
+	FClimbDataCells VaultSpanCells;
+
+	//number of loaded surfaces built from each primitive, one primitive can be baked by several data actors
+	TMap<FSoftObjectPath, int32> BakedComponents;
+};
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CLSClimbTelemetry.h"
+
+#if CLS_WITH_CLIMB_TELEMETRY
+
+#include "ClimbingSystem.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+
+FClimbSessionTelemetry& FClimbSessionTelemetry::Get()
+{
+	static FClimbSessionTelemetry telemetry;
+	return telemetry;
+}
+
+FClimbSessionTelemetry::FClimbSessionTelemetry()
+	: SessionStart {FDateTime::UtcNow()}
+{
+	FCoreDelegates::OnEndFrame.AddRaw(this, &FClimbSessionTelemetry::OnEndFrame);
+	FCoreDelegates::OnPreExit.AddRaw(this, &FClimbSessionTelemetry::WriteSummary);
+}
+
+void FClimbSessionTelemetry::AddStateDuration(EClimbState State, double Seconds)
+{
+	StateDurations[(int32)State] += Seconds;
+}
+
+void FClimbSessionTelemetry::AddTransition(EClimbState From, EClimbState To)
+{
+	++TransitionCounts[(int32)From][(int32)To];
+	++CurrentFrame.Transitions;
+}
+
+void FClimbSessionTelemetry::AddFailedClimbAttempt()
+{
+	++FailedClimbAttempts;
+}
+
+void FClimbSessionTelemetry::AddPhysCustomTime(double Seconds)
+{
+	CurrentFrame.PhysCustomSeconds += Seconds;
+}
+
+void FClimbSessionTelemetry::AddQueries(int32 NumQueries)
+{
+	CurrentFrame.Queries += NumQueries;
+	TotalQueries += NumQueries;
+}
+
+void FClimbSessionTelemetry::AddActiveClimber()
+{
+	++CurrentFrame.ActiveClimbers;
+}
+
+void FClimbSessionTelemetry::OnEndFrame()
+{
+	if (CurrentFrame.ActiveClimbers > 0)
+	{
+		++NumClimbFrames;
+	}
+
+	if (CurrentFrame.PhysCustomSeconds > WorstFrame.PhysCustomSeconds)
+	{
+		WorstFrame = CurrentFrame;
+		WorstFrame.Frame = GFrameCounter;
+	}
+
+	CurrentFrame = FFrameStats {};
+}
+
+void FClimbSessionTelemetry::WriteSummary()
+{
+	const TSharedRef<FJsonObject> summary {MakeShared<FJsonObject>()};
+	summary->SetStringField(TEXT("SessionStart"), SessionStart.ToIso8601());
+	summary->SetNumberField(TEXT("SessionSeconds"), (FDateTime::UtcNow() - SessionStart).GetTotalSeconds());
+	summary->SetNumberField(TEXT("ClimbFrames"), (double)NumClimbFrames);
+	summary->SetNumberField(TEXT("TotalQueries"), (double)TotalQueries);
+	summary->SetNumberField(TEXT("FailedClimbAttempts"), FailedClimbAttempts);
+
+	const TSharedRef<FJsonObject> stateDurations {MakeShared<FJsonObject>()};
+	const TSharedRef<FJsonObject> transitions {MakeShared<FJsonObject>()};
+	for (int32 from = 0; from < (int32)EClimbState::Count; ++from)
+	{
+		const FString fromName {StaticEnum<EClimbState>()->GetNameStringByIndex(from)};
+		stateDurations->SetNumberField(fromName, StateDurations[from]);
+
+		for (int32 to = 0; to < (int32)EClimbState::Count; ++to)
+		{
+			if (TransitionCounts[from][to] > 0)
+			{
+				transitions->SetNumberField(fromName + TEXT("->") + StaticEnum<EClimbState>()->GetNameStringByIndex(to), TransitionCounts[from][to]);
+			}
+		}
+	}
+	summary->SetObjectField(TEXT("StateSeconds"), stateDurations);
+	summary->SetObjectField(TEXT("Transitions"), transitions);
+
+	const TSharedRef<FJsonObject> worstFrame {MakeShared<FJsonObject>()};
+	worstFrame->SetNumberField(TEXT("Frame"), (double)WorstFrame.Frame);
+	worstFrame->SetNumberField(TEXT("PhysCustomMs"), WorstFrame.PhysCustomSeconds * 1000.0);
+	worstFrame->SetNumberField(TEXT("Queries"), WorstFrame.Queries);
+	worstFrame->SetNumberField(TEXT("Transitions"), WorstFrame.Transitions);
+	worstFrame->SetNumberField(TEXT("ActiveClimbers"), WorstFrame.ActiveClimbers);
+	summary->SetObjectField(TEXT("WorstFrame"), worstFrame);
+
+	FString summaryString;
+	const TSharedRef<TJsonWriter<>> jsonWriter {TJsonWriterFactory<>::Create(&summaryString)};
+	FJsonSerializer::Serialize(summary, jsonWriter);
+
+	const FString filePath {FPaths::ProjectSavedDir() / TEXT("ClimbTelemetry") / FString::Printf(TEXT("Session_%s.json"), *SessionStart.ToString())};
+	if (FFileHelper::SaveStringToFile(summaryString, *filePath))
+	{
+		UE_LOG(LogClimbingSystem, Log, TEXT("Climb session telemetry written to %s"), *filePath);
+	}
+}
+
+#endif
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CLSMovementComponent.h"
+
+//Session telemetry is available in every build but Shipping, including Test builds of dedicated servers
+#ifndef CLS_WITH_CLIMB_TELEMETRY
+#define CLS_WITH_CLIMB_TELEMETRY !UE_BUILD_SHIPPING
+#endif
+
+#if CLS_WITH_CLIMB_TELEMETRY
+
+/**
+ * Per-session climbing summary of all characters of the process.
+ * Counters are accumulated during the session and written as json to Saved/ClimbTelemetry on exit
+ */
+class FClimbSessionTelemetry
+{
+public:
+	static FClimbSessionTelemetry& Get();
+
+	void AddStateDuration(EClimbState State, double Seconds);
+	void AddTransition(EClimbState From, EClimbState To);
+	void AddFailedClimbAttempt();
+	void AddPhysCustomTime(double Seconds);
+	void AddQueries(int32 NumQueries);
+	void AddActiveClimber();
+
+private:
+	FClimbSessionTelemetry();
+
+	void OnEndFrame();
+	void WriteSummary();
+
+	struct FFrameStats
+	{
+		uint64 Frame {0};
+		double PhysCustomSeconds {0.0};
+		int32 Queries {0};
+		int32 Transitions {0};
+		int32 ActiveClimbers {0};
+	};
+
+	double StateDurations[(int32)EClimbState::Count] {};
+	int32 TransitionCounts[(int32)EClimbState::Count][(int32)EClimbState::Count] {};
+	int32 FailedClimbAttempts {0};
+	int64 TotalQueries {0};
+	uint64 NumClimbFrames {0};
+
+	FFrameStats CurrentFrame;
+	FFrameStats WorstFrame;
+
+	FDateTime SessionStart;
+};
+
+#endif
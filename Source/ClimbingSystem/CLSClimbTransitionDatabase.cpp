@@ -0,0 +1,239 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CLSClimbTransitionDatabase.h"
+#include "Animation/AnimMontage.h"
+#include "CLSRootMotionSource.h"
+#include "ClimbingSystem.h"
+
+#if WITH_EDITOR
+#include "UObject/ObjectSaveContext.h"
+#include "AnimNotifyState_MotionWarping.h"
+#include "RootMotionModifier.h"
+#endif
+
+const FName UCLSClimbTransitionDatabase::WarpTargetName {TEXT("ClimbTransitionTarget")};
+
+const FClimbTransitionClip* UCLSClimbTransitionDatabase::FindClosestClip(EClimbState Transition, const FClimbTransitionQuery& Query) const
+{
+	const FClimbTransitionIndex* index {Indices.FindByPredicate([Transition](const FClimbTransitionIndex& Index) {return Index.Transition == Transition;})};
+	if (index == nullptr || index->Root == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	int32 bestNode {INDEX_NONE};
+	float bestDistSquared {TNumericLimits<float>::Max()};
+	FindClosestInSubtree(*index, index->Root, MakeFeatures(Query.TargetTranslation, Query.Speed), bestNode, bestDistSquared);
+
+	if (bestNode == INDEX_NONE)
+	{
+		return nullptr;
+	}
+
+	const int32 clipIndex {index->Nodes[bestNode].ClipIndex};
+	return Clips.IsValidIndex(clipIndex) ? &Clips[clipIndex] : nullptr;
+}
+
+bool UCLSClimbTransitionDatabase::ContainsMontage(const UAnimMontage* Montage) const
+{
+	return Montage != nullptr && Clips.ContainsByPredicate([Montage](const FClimbTransitionClip& Clip) {return Clip.Montage.Get() == Montage;});
+}
+
+TArray<FSoftObjectPath> UCLSClimbTransitionDatabase::GetMontagePaths() const
+{
+	TArray<FSoftObjectPath> montagePaths;
+
+	for (const FClimbTransitionClip& clip : Clips)
+	{
+		if (!clip.Montage.IsNull())
+		{
+			montagePaths.AddUnique(clip.Montage.ToSoftObjectPath());
+		}
+	}
+
+	return montagePaths;
+}
+
+FVector4f UCLSClimbTransitionDatabase::MakeFeatures(const FVector& Translation, float Speed) const
+{
+	const FVector3f weightedTranslation {FVector3f(Translation) * TranslationWeight};
+	return FVector4f(weightedTranslation.X, weightedTranslation.Y, weightedTranslation.Z, Speed * SpeedWeight);
+}
+
+void UCLSClimbTransitionDatabase::FindClosestInSubtree(const FClimbTransitionIndex& Index, int32 NodeIndex, const FVector4f& Features, int32& OutBestNode, float& OutBestDistSquared) const
+{
+	if (NodeIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FClimbTransitionIndexNode& node {Index.Nodes[NodeIndex]};
+
+	const FVector4f delta {Features - node.Features};
+	const float distSquared {Dot4(delta, delta)};
+	if (distSquared < OutBestDistSquared)
+	{
+		OutBestDistSquared = distSquared;
+		OutBestNode = NodeIndex;
+	}
+
+	const float splitDelta {delta[node.SplitAxis]};
+	const int32 nearChild {splitDelta < 0.f ? node.Left : node.Right};
+	const int32 farChild {splitDelta < 0.f ? node.Right : node.Left};
+
+	FindClosestInSubtree(Index, nearChild, Features, OutBestNode, OutBestDistSquared);
+
+	//other side can only be closer if the split plane is
+	if (FMath::Square(splitDelta) < OutBestDistSquared)
+	{
+		FindClosestInSubtree(Index, farChild, Features, OutBestNode, OutBestDistSquared);
+	}
+}
+
+#if WITH_EDITOR
+
+void UCLSClimbTransitionDatabase::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	Super::PreSave(ObjectSaveContext);
+
+	BuildIndex();
+}
+
+void UCLSClimbTransitionDatabase::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	BuildIndex();
+}
+
+void UCLSClimbTransitionDatabase::BuildIndex()
+{
+	Indices.Reset();
+
+	for (FClimbTransitionClip& clip : Clips)
+	{
+		ExtractClipFeatures(clip);
+	}
+
+	for (const EClimbState transition : {EClimbState::Entering, EClimbState::ToppingOut, EClimbState::Vaulting, EClimbState::Descending})
+	{
+		FClimbTransitionIndex& index {Indices.AddDefaulted_GetRef()};
+		index.Transition = transition;
+
+		for (int32 clipIndex = 0; clipIndex < Clips.Num(); ++clipIndex)
+		{
+			const FClimbTransitionClip& clip {Clips[clipIndex]};
+			if (clip.Transition != transition || clip.Montage.IsNull())
+			{
+				continue;
+			}
+
+			//without a window the warp target is ignored and the clip ends wherever its root motion does
+			if (!clip.bHasWarpWindow)
+			{
+				UE_LOG(LogClimbingSystem, Warning, TEXT("%s: %s has no motion warping window for %s, clip is not indexed"), *GetName(), *clip.Montage.ToString(), *WarpTargetName.ToString());
+				continue;
+			}
+
+			FClimbTransitionIndexNode& node {index.Nodes.AddDefaulted_GetRef()};
+			node.ClipIndex = clipIndex;
+			node.Features = MakeFeatures(clip.EndTranslation, clip.EntrySpeed);
+		}
+
+		index.Root = BuildSubtree(index.Nodes, 0, index.Nodes.Num());
+	}
+
+	UE_LOG(LogClimbingSystem, Log, TEXT("%s: indexed %d climb transition clips"), *GetName(), Clips.Num());
+}
+
+void UCLSClimbTransitionDatabase::ExtractClipFeatures(FClimbTransitionClip& Clip) const
+{
+	Clip.EndTranslation = FVector::ZeroVector;
+	Clip.EntrySpeed = 0.f;
+	Clip.bHasWarpWindow = false;
+
+	const UAnimMontage* montage {Clip.Montage.LoadSynchronous()};
+	if (montage == nullptr)
+	{
+		return;
+	}
+
+	Clip.bHasWarpWindow = HasWarpWindow(*montage);
+
+	const FQuat meshToActorRotation {FRotator(0.f, MeshToActorYaw, 0.f).Quaternion()};
+	const FClimbTransitionTrack track {FClimbTransitionTrack::Extract(*montage, meshToActorRotation, FeatureSampleRate)};
+
+	Clip.EndTranslation = track.GetEndTranslation();
+
+	const float entryTime {FMath::Min(EntrySpeedSampleTime, track.PlayLength)};
+	if (entryTime > 0.f)
+	{
+		Clip.EntrySpeed = track.Sample(entryTime).Size() / entryTime;
+	}
+}
+
+bool UCLSClimbTransitionDatabase::HasWarpWindow(const UAnimMontage& Montage)
+{
+	for (const FAnimNotifyEvent& notifyEvent : Montage.Notifies)
+	{
+		const UAnimNotifyState_MotionWarping* motionWarpingNotify {Cast<UAnimNotifyState_MotionWarping>(notifyEvent.NotifyStateClass)};
+		const URootMotionModifier_Warp* warpModifier {motionWarpingNotify ? Cast<URootMotionModifier_Warp>(motionWarpingNotify->RootMotionModifier) : nullptr};
+
+		if (warpModifier != nullptr && warpModifier->WarpTargetName == WarpTargetName)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int32 UCLSClimbTransitionDatabase::BuildSubtree(TArray<FClimbTransitionIndexNode>& Nodes, int32 First, int32 Count) const
+{
+	if (Count <= 0)
+	{
+		return INDEX_NONE;
+	}
+
+	TArrayView<FClimbTransitionIndexNode> subtreeNodes {MakeArrayView(Nodes.GetData() + First, Count)};
+
+	//split along the axis clips differ the most
+	FVector4f minFeatures {subtreeNodes[0].Features};
+	FVector4f maxFeatures {subtreeNodes[0].Features};
+	for (const FClimbTransitionIndexNode& node : subtreeNodes)
+	{
+		for (int32 axis = 0; axis < 4; ++axis)
+		{
+			minFeatures[axis] = FMath::Min(minFeatures[axis], node.Features[axis]);
+			maxFeatures[axis] = FMath::Max(maxFeatures[axis], node.Features[axis]);
+		}
+	}
+
+	uint8 splitAxis {0};
+	for (uint8 axis = 1; axis < 4; ++axis)
+	{
+		if (maxFeatures[axis] - minFeatures[axis] > maxFeatures[splitAxis] - minFeatures[splitAxis])
+		{
+			splitAxis = axis;
+		}
+	}
+
+	subtreeNodes.Sort([splitAxis](const FClimbTransitionIndexNode& A, const FClimbTransitionIndexNode& B) {return A.Features[splitAxis] < B.Features[splitAxis];});
+
+	//median becomes the root, nodes stay in place so children are just ranges on both sides of it
+	const int32 median {Count / 2};
+	const int32 rootIndex {First + median};
+
+	const int32 left {BuildSubtree(Nodes, First, median)};
+	const int32 right {BuildSubtree(Nodes, rootIndex + 1, Count - median - 1)};
+
+	FClimbTransitionIndexNode& root {Nodes[rootIndex]};
+	root.SplitAxis = splitAxis;
+	root.Left = left;
+	root.Right = right;
+
+	return rootIndex;
+}
+
+#endif
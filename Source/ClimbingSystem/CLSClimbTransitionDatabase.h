@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "CLSMovementComponent.h"
+#include "CLSClimbTransitionDatabase.generated.h"
+
+class UAnimMontage;
+
+//One transition animation and features extracted from its root motion
+USTRUCT(BlueprintType)
+struct FClimbTransitionClip
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, category = "Climb Transition")
+	TSoftObjectPtr<UAnimMontage> Montage;
+
+	//Climb state the clip is played in: Entering, ToppingOut, Vaulting or Descending
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, category = "Climb Transition")
+	EClimbState Transition {EClimbState::Entering};
+
+	//Root translation at the end of the clip, in actor local space
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Climb Transition")
+	FVector EndTranslation {FVector::ZeroVector};
+
+	//Root speed at the start of the clip
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Climb Transition")
+	float EntrySpeed {0.f};
+
+	//Montage has a motion warping window for UCLSClimbTransitionDatabase::WarpTargetName, clips without it are not indexed
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Climb Transition")
+	bool bHasWarpWindow {false};
+};
+
+//What the character needs from the transition, in actor local space
+struct FClimbTransitionQuery
+{
+	FVector TargetTranslation {FVector::ZeroVector};
+	float Speed {0.f};
+};
+
+USTRUCT()
+struct FClimbTransitionIndexNode
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 ClipIndex {INDEX_NONE};
+
+	//weighted clip features, see UCLSClimbTransitionDatabase::MakeFeatures
+	UPROPERTY()
+	FVector4f Features {0.f, 0.f, 0.f, 0.f};
+
+	UPROPERTY()
+	int32 Left {INDEX_NONE};
+
+	UPROPERTY()
+	int32 Right {INDEX_NONE};
+
+	UPROPERTY()
+	uint8 SplitAxis {0};
+};
+
+//KD-tree over clips of one transition
+USTRUCT()
+struct FClimbTransitionIndex
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	EClimbState Transition {EClimbState::Entering};
+
+	UPROPERTY()
+	TArray<FClimbTransitionIndexNode> Nodes;
+
+	UPROPERTY()
+	int32 Root {INDEX_NONE};
+};
+
+/**
+ * Climb transition animations indexed by their root motion. The movement component picks the clip
+ * that ends closest to where the character has to go and warps it to the exact target.
+ * Clips are matched only on end translation and entry speed, there are no trajectory or contact features,
+ * so the warp has to fix whatever the path in between doesn't fit.
+ * Features are extracted and the index is rebuilt in editor on save or manually with BuildIndex,
+ * so a query at runtime only walks the prebuilt tree
+ */
+UCLASS(BlueprintType)
+class CLIMBINGSYSTEM_API UCLSClimbTransitionDatabase : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	//Warp target selected clips are warped to, every montage needs a motion warping window for it
+	static const FName WarpTargetName;
+
+	//returns the clip of given transition closest to the query, nullptr if there is none
+	const FClimbTransitionClip* FindClosestClip(EClimbState Transition, const FClimbTransitionQuery& Query) const;
+
+	bool ContainsMontage(const UAnimMontage* Montage) const;
+
+	TArray<FSoftObjectPath> GetMontagePaths() const;
+
+	FORCEINLINE const TArray<FClimbTransitionClip>& GetClips() const {return Clips;};
+
+#if WITH_EDITOR
+	UFUNCTION(CallInEditor, category = "Climb Transition")
+	void BuildIndex();
+
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+private:
+	FVector4f MakeFeatures(const FVector& Translation, float Speed) const;
+
+#if WITH_EDITOR
+	void ExtractClipFeatures(FClimbTransitionClip& Clip) const;
+
+	static bool HasWarpWindow(const UAnimMontage& Montage);
+
+	//builds subtree from the clips in Nodes[First, First + Count), returns its root
+	int32 BuildSubtree(TArray<FClimbTransitionIndexNode>& Nodes, int32 First, int32 Count) const;
+#endif
+
+	void FindClosestInSubtree(const FClimbTransitionIndex& Index, int32 NodeIndex, const FVector4f& Features, int32& OutBestNode, float& OutBestDistSquared) const;
+
+	UPROPERTY(EditAnywhere, category = "Climb Transition")
+	TArray<FClimbTransitionClip> Clips;
+
+	//Rotation from skeletal mesh to actor space, same as mesh relative rotation on the character
+	UPROPERTY(EditAnywhere, category = "Climb Transition")
+	float MeshToActorYaw {-90.f};
+
+	//Samples per second used to extract root motion
+	UPROPERTY(EditAnywhere, category = "Climb Transition", meta = (ClampMin = "1", UIMin = "1"))
+	float FeatureSampleRate {30.f};
+
+	//Entry speed is measured over that time from the start of the clip
+	UPROPERTY(EditAnywhere, category = "Climb Transition", meta = (ClampMin = "0.01", UIMin = "0.01"))
+	float EntrySpeedSampleTime {0.2f};
+
+	//How much one centimeter of end location difference counts
+	UPROPERTY(EditAnywhere, category = "Climb Transition", meta = (ClampMin = "0", UIMin = "0"))
+	float TranslationWeight {1.f};
+
+	//How much one cm/s of entry speed difference counts
+	UPROPERTY(EditAnywhere, category = "Climb Transition", meta = (ClampMin = "0", UIMin = "0"))
+	float SpeedWeight {0.1f};
+
+	UPROPERTY()
+	TArray<FClimbTransitionIndex> Indices;
+};
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CLSHandholdComponent.h"
+#include "CLSHandholdSubsystem.h"
+
+UCLSHandholdComponent::UCLSHandholdComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+FVector UCLSHandholdComponent::GetHangLocation() const
+{
+	return GetComponentLocation() + GetHoldNormal() * HangOffset.X - FVector::UpVector * HangOffset.Y;
+}
+
+void UCLSHandholdComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	if (UCLSHandholdSubsystem* handholdSubsystem {GetWorld() ? GetWorld()->GetSubsystem<UCLSHandholdSubsystem>() : nullptr})
+	{
+		handholdSubsystem->RegisterHandhold(this);
+	}
+}
+
+void UCLSHandholdComponent::OnUnregister()
+{
+	if (UCLSHandholdSubsystem* handholdSubsystem {GetWorld() ? GetWorld()->GetSubsystem<UCLSHandholdSubsystem>() : nullptr})
+	{
+		handholdSubsystem->UnregisterHandhold(this);
+	}
+
+	Super::OnUnregister();
+}
+
+void UCLSHandholdComponent::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+
+	//moving holds change their cell
+	if (UCLSHandholdSubsystem* handholdSubsystem {GetWorld() ? GetWorld()->GetSubsystem<UCLSHandholdSubsystem>() : nullptr})
+	{
+		handholdSubsystem->UpdateHandhold(this);
+	}
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/SceneComponent.h"
+#include "CLSHandholdComponent.generated.h"
+
+/**
+ * Discrete grip point for climbing (ladder rung, peg, pipe).
+ * Component forward vector is the outward normal of the hold, character hangs facing against it.
+ * Handholds are indexed by UCLSHandholdSubsystem, climbing between them needs no physics queries
+ */
+UCLASS(ClassGroup = Climbing, meta = (BlueprintSpawnableComponent))
+class CLIMBINGSYSTEM_API UCLSHandholdComponent : public USceneComponent
+{
+	GENERATED_BODY()
+
+public:
+	UCLSHandholdComponent();
+
+	//capsule center location of a character hanging on this hold
+	FVector GetHangLocation() const;
+
+	FORCEINLINE FVector GetHoldNormal() const {return GetForwardVector();};
+
+	FORCEINLINE bool IsHandholdEnabled() const {return bHandholdEnabled;};
+
+protected:
+	virtual void OnRegister() override;
+	virtual void OnUnregister() override;
+	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport) override;
+
+private:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Climbing", meta = (AllowPrivateAccess = "true"))
+	bool bHandholdEnabled {true};
+
+	//Character offset from the hold: X - along hold normal, Y - down
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Climbing", meta = (AllowPrivateAccess = "true"))
+	FVector2D HangOffset {40.f, 90.f};
+};
@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CLSHandholdSubsystem.h"
+#include "CLSHandholdComponent.h"
+
+void UCLSHandholdSubsystem::RegisterHandhold(UCLSHandholdComponent* Handhold)
+{
+	if (Handhold == nullptr)
+	{
+		return;
+	}
+
+	const FIntVector cell {GetCell(Handhold->GetComponentLocation())};
+	HandholdToCell.Add(Handhold, cell);
+
+	TArray<TWeakObjectPtr<UCLSHandholdComponent>>& cellHandholds {HandholdCells.FindOrAdd(cell)};
+	if (!cellHandholds.Contains(Handhold))
+	{
+		cellHandholds.Add(Handhold);
+		++NumHandholds;
+	}
+}
+
+void UCLSHandholdSubsystem::UnregisterHandhold(UCLSHandholdComponent* Handhold)
+{
+	if (Handhold == nullptr)
+	{
+		return;
+	}
+
+	FIntVector cell;
+	if (!HandholdToCell.RemoveAndCopyValue(Handhold, cell))
+	{
+		return;
+	}
+
+	if (TArray<TWeakObjectPtr<UCLSHandholdComponent>>* cellHandholds {HandholdCells.Find(cell)})
+	{
+		if (cellHandholds->RemoveSwap(Handhold) > 0)
+		{
+			--NumHandholds;
+		}
+
+		if (cellHandholds->IsEmpty())
+		{
+			HandholdCells.Remove(cell);
+		}
+	}
+}
+
+void UCLSHandholdSubsystem::UpdateHandhold(UCLSHandholdComponent* Handhold)
+{
+	const FIntVector* cell {HandholdToCell.Find(Handhold)};
+	if (cell == nullptr || GetCell(Handhold->GetComponentLocation()) == *cell)
+	{
+		return;
+	}
+
+	UnregisterHandhold(Handhold);
+	RegisterHandhold(Handhold);
+}
+
+UCLSHandholdComponent* UCLSHandholdSubsystem::FindBestHandhold(const FVector& From, const FVector& Direction, const FVector& FacingNormal, float Reach, const UCLSHandholdComponent* IgnoredHandhold) const
+{
+	const FIntVector minCell {GetCell(From - FVector {Reach})};
+	const FIntVector maxCell {GetCell(From + FVector {Reach})};
+	const FVector searchDirection {Direction.GetSafeNormal()};
+	const bool bHasDirection {!searchDirection.IsNearlyZero()};
+
+	UCLSHandholdComponent* bestHandhold {nullptr};
+	float bestScore {TNumericLimits<float>::Lowest()};
+
+	for (int32 x = minCell.X; x <= maxCell.X; ++x)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+		{
+			for (int32 z = minCell.Z; z <= maxCell.Z; ++z)
+			{
+				const TArray<TWeakObjectPtr<UCLSHandholdComponent>>* cellHandholds {HandholdCells.Find(FIntVector {x, y, z})};
+				if (cellHandholds == nullptr)
+				{
+					continue;
+				}
+
+				for (const TWeakObjectPtr<UCLSHandholdComponent>& weakHandhold : *cellHandholds)
+				{
+					UCLSHandholdComponent* handhold {weakHandhold.Get()};
+					if (handhold == nullptr || handhold == IgnoredHandhold || !handhold->IsHandholdEnabled())
+					{
+						continue;
+					}
+
+					if (FVector::DotProduct(handhold->GetHoldNormal(), FacingNormal) < MinFacingDot)
+					{
+						continue;
+					}
+
+					const FVector toHandhold {handhold->GetComponentLocation() - From};
+					const float distance {(float)toHandhold.Size()};
+					if (distance > Reach)
+					{
+						continue;
+					}
+
+					//prefer holds along the direction, then closer ones
+					float score {1.f - distance / Reach};
+					if (bHasDirection)
+					{
+						const float directionDot {distance > KINDA_SMALL_NUMBER ? (float)FVector::DotProduct(toHandhold / distance, searchDirection) : 0.f};
+						if (directionDot < MinDirectionDot)
+						{
+							continue;
+						}
+						score += 2.f * directionDot;
+					}
+
+					if (score > bestScore)
+					{
+						bestScore = score;
+						bestHandhold = handhold;
+					}
+				}
+			}
+		}
+	}
+
+	return bestHandhold;
+}
+
+FIntVector UCLSHandholdSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntVector
+	{
+		FMath::FloorToInt32(Location.X / CellSize),
+		FMath::FloorToInt32(Location.Y / CellSize),
+		FMath::FloorToInt32(Location.Z / CellSize)
+	};
+}
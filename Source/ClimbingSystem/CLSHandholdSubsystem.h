@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CLSHandholdSubsystem.generated.h"
+
+class UCLSHandholdComponent;
+
+/**
+ * Indexes all handholds of the world in a spatial hash so climbing can pick the next hold without physics queries
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UCLSHandholdSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	void RegisterHandhold(UCLSHandholdComponent* Handhold);
+	void UnregisterHandhold(UCLSHandholdComponent* Handhold);
+	void UpdateHandhold(UCLSHandholdComponent* Handhold);
+
+	/*
+		Returns reachable hold that fits Direction best.
+		Direction may be zero, then the closest hold is returned.
+		Holds facing away from FacingNormal are skipped
+	*/
+	UCLSHandholdComponent* FindBestHandhold(const FVector& From, const FVector& Direction, const FVector& FacingNormal, float Reach, const UCLSHandholdComponent* IgnoredHandhold = nullptr) const;
+
+	FORCEINLINE int32 GetNumHandholds() const {return NumHandholds;};
+
+private:
+	FIntVector GetCell(const FVector& Location) const;
+
+	//cell size should be around max reach so lookups touch only a few cells
+	static constexpr float CellSize {150.f};
+
+	//Min cosine between hold normal and facing normal
+	static constexpr float MinFacingDot {0.5f};
+
+	//Min cosine between direction to the hold and requested direction
+	static constexpr float MinDirectionDot {0.4f};
+
+	TMap<FIntVector, TArray<TWeakObjectPtr<UCLSHandholdComponent>>> HandholdCells;
+
+	//cell every registered hold is stored in
+	TMap<TObjectKey<UCLSHandholdComponent>, FIntVector> HandholdToCell;
+
+	int32 NumHandholds {0};
+};
@@ -6,12 +6,157 @@
 #include "GameFramework/Character.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "MotionWarpingComponent.h"
+#include "ClimbingSystem.h"
+#include "Animation/AnimMontage.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "UObject/UObjectIterator.h"
+#include "TimerManager.h"
+#include "Components/CapsuleComponent.h"
+#include "CLSRootMotionSource.h"
+#include "GameFramework/PlayerController.h"
+#include "Camera/PlayerCameraManager.h"
+#include "CLSHandholdComponent.h"
+#include "CLSHandholdSubsystem.h"
+#include "CLSClimbDataSubsystem.h"
+#include "CLSClimbTransitionDatabase.h"
+#include "CLSClimbTelemetry.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Misc/ScopeExit.h"
+
+DECLARE_STATS_GROUP(TEXT("Climbing"), STATGROUP_Climbing, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Climb move sweeps"), STAT_ClimbMoveSweeps, STATGROUP_Climbing);
+DECLARE_CYCLE_STAT(TEXT("Climb transition selection"), STAT_ClimbTransitionSelection, STATGROUP_Climbing);
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Climb moves accepted"), STAT_ClimbMovesAccepted, STATGROUP_Climbing);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Climb validation probes"), STAT_ClimbValidationProbes, STATGROUP_Climbing);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Climb moves rejected"), STAT_ClimbMovesRejected, STATGROUP_Climbing);
+
+CSV_DEFINE_CATEGORY(Climbing, true);
+
+static TAutoConsoleVariable<bool> CVarClimbMoveValidation(
+	TEXT("CLS.ClimbMoveValidation"),
+	true,
+	TEXT("Server accepts client climb positions validated against cached surface contact instead of re-running climb queries"));
+
+static void CountClimbQueries(int32 NumQueries)
+{
+	CSV_CUSTOM_STAT(Climbing, Queries, NumQueries, ECsvCustomStatOp::Accumulate);
+
+#if CLS_WITH_CLIMB_TELEMETRY
+	FClimbSessionTelemetry::Get().AddQueries(NumQueries);
+#endif
+}
+
+static FAutoConsoleCommandWithWorld CReportClimbAnimationsCommand(
+	TEXT("CLS.ReportClimbAnimations"),
+	TEXT("Logs loading state and memory of climb animations for every climbing character"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		SIZE_T totalSize {0};
+		for (TObjectIterator<UCLSMovementComponent> It; It; ++It)
+		{
+			if (It->GetWorld() != World || It->IsTemplate())
+			{
+				continue;
+			}
+
+			const SIZE_T animationsSize {It->GetClimbAnimationsMemorySize()};
+			totalSize += animationsSize;
+			UE_LOG(LogClimbingSystem, Display, TEXT("%s: loaded %d, %.1f KB"), *GetNameSafe(It->GetOwner()), It->AreClimbAnimationsLoaded(), animationsSize / 1024.f);
+		}
+		UE_LOG(LogClimbingSystem, Display, TEXT("Climb animations total: %.1f KB"), totalSize / 1024.f);
+	}));
+
+static TAutoConsoleVariable<int32> CVarFallCatchBudget(
+	TEXT("CLS.FallCatchBudget"),
+	4,
+	TEXT("Max number of full fall catch checks per frame across all characters"));
+
+#if CLS_WITH_TRACE_RECORDER
+
+static FAutoConsoleCommandWithWorldAndArgs CDrawClimbQueriesCommand(
+	TEXT("CLS.DrawClimbQueries"),
+	TEXT("Draws recorded climb queries of every climbing character. Optional arg: draw duration in seconds"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		const float drawDuration {Args.Num() > 0 ? FCString::Atof(*Args[0]) : 5.f};
+		for (TObjectIterator<UCLSMovementComponent> It; It; ++It)
+		{
+			if (It->GetWorld() == World && !It->IsTemplate())
+			{
+				It->GetTraceRecorder().Draw(World, drawDuration);
+			}
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld CDumpClimbQueriesCommand(
+	TEXT("CLS.DumpClimbQueries"),
+	TEXT("Writes recorded climb queries of every climbing character to Saved/ClimbQueries as csv"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		const FString dumpDirectory {FPaths::ProjectSavedDir() / TEXT("ClimbQueries")};
+		const FString timeStamp {FDateTime::Now().ToString()};
+
+		for (TObjectIterator<UCLSMovementComponent> It; It; ++It)
+		{
+			if (It->GetWorld() != World || It->IsTemplate())
+			{
+				continue;
+			}
+
+			const FString filePath {dumpDirectory / FString::Printf(TEXT("%s_%s.csv"), *GetNameSafe(It->GetOwner()), *timeStamp)};
+			if (It->GetTraceRecorder().ExportCsv(filePath))
+			{
+				UE_LOG(LogClimbingSystem, Display, TEXT("%d climb queries written to %s"), It->GetTraceRecorder().Num(), *filePath);
+			}
+		}
+	}));
+
+#endif
+
+static FAutoConsoleCommandWithWorld CReportClimbValidationCommand(
+	TEXT("CLS.ReportClimbValidation"),
+	TEXT("Logs server climb move validation metrics for every climbing character"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		for (TObjectIterator<UCLSMovementComponent> It; It; ++It)
+		{
+			if (It->GetWorld() == World && !It->IsTemplate())
+			{
+				UE_LOG(LogClimbingSystem, Display, TEXT("%s: accepted %d, probes %d, rejected %d"), *GetNameSafe(It->GetOwner()),
+					It->GetNumAcceptedClimbMoves(), It->GetNumClimbValidationProbes(), It->GetNumRejectedClimbMoves());
+			}
+		}
+	}));
 
 #pragma region ClimbTraces
 
 void UCLSMovementComponent::TickComponent(float DeltaTime, enum ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
 {
+	TickCapsuleMorph(DeltaTime);
+
 	Super::TickComponent(DeltaTime,TickType, ThisTickFunction);
+
+	UpdateClimbAnimationsPreload(DeltaTime);
+
+	if (IsClimbing())
+	{
+		CSV_CUSTOM_STAT(Climbing, ClimbersActive, 1, ECsvCustomStatOp::Accumulate);
+
+#if CLS_WITH_CLIMB_TELEMETRY
+		FClimbSessionTelemetry::Get().AddActiveClimber();
+#endif
+	}
+
+	if (ShouldProbeClimbLimbs())
+	{
+		IssueClimbLimbProbes();
+	}
+	else
+	{
+		ResetClimbLimbTargets();
+	}
 }
 
 void UCLSMovementComponent::BeginPlay()
@@ -19,14 +164,31 @@ void UCLSMovementComponent::BeginPlay()
 	Super::BeginPlay();
 
 	UAnimInstance* playerAnimInstance{ GetCharacterOwner()->GetMesh()->GetAnimInstance() };
-	playerAnimInstance->OnMontageEnded.AddDynamic(this, &ThisClass::OnClimbMontageEnded);
+	//transition is finished once montage starts blending out, OnMontageEnded would only repeat the same event
 	playerAnimInstance->OnMontageBlendingOut.AddDynamic(this, &ThisClass::OnClimbMontageEnded);
+
+	ClimbLimbProbeDelegate.BindUObject(this, &ThisClass::OnClimbLimbProbeCompleted);
+}
+
+void UCLSMovementComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	ReleaseClimbAnimations();
+
+#if CLS_WITH_CLIMB_TELEMETRY
+	FClimbSessionTelemetry::Get().AddStateDuration(ClimbState, GetWorld()->GetTimeSeconds() - ClimbStateEnterTime);
+#endif
+
+	if (UWorld* world = GetWorld())
+	{
+		world->GetTimerManager().ClearTimer(ClimbTransitionEndTimer);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 FVector UCLSMovementComponent::ConstrainAnimRootMotionVelocity(const FVector& RootMotionVelocity, const FVector& CurrentVelocity) const
 {
-	UAnimInstance* playerAnimInstance{ GetCharacterOwner()->GetMesh()->GetAnimInstance() };
-	if (IsFalling() && playerAnimInstance->IsAnyMontagePlaying())
+	if (IsFalling() && IsPlayingClimbTransition())
 	{
 		return RootMotionVelocity;
 	}
@@ -67,17 +229,75 @@ void UCLSMovementComponent::OnMovementModeChanged(EMovementMode PreviousMovement
 	{
 		bOrientRotationToMovement = false;
 		OnEnterClimbStateDelegate.ExecuteIfBound();
+
+		if (IsValidatingClimbMoves())
+		{
+			//surface info may be left from the previous climb, seed the patch from contacts where this one starts
+			if (TraceClimbSurfaces())
+			{
+				GetClimbSurfaceInfo();
+			}
+			else
+			{
+				CurrentClimableSurfLocation = FVector::ZeroVector;
+				CurrentClimableSurfNormal = FVector::ZeroVector;
+			}
+			ClimbValidationPatch = FClimbValidationPatch {CurrentClimableSurfLocation, CurrentClimableSurfNormal, !CurrentClimableSurfNormal.IsNearlyZero(),
+				ClimbContacts.IsEmpty() ? TWeakObjectPtr<UPrimitiveComponent>() : ClimbContacts[0].Component};
+
+			//validated client positions are taken as is, see ServerCheckClientError. Without a patch moves are checked the usual way
+			if (ClimbValidationPatch.bValid)
+			{
+				bAcceptClientPositionBeforeClimb = bServerAcceptClientAuthoritativePosition;
+				bServerAcceptClientAuthoritativePosition = true;
+				bAcceptClientPositionOverridden = true;
+			}
+		}
 	}
 	else if (!IsClimbing() && PreviousMovementMode == MOVE_Custom && PreviousCustomMode == (uint8)ECustomMovementMode::MOVE_Climb)
 	{
 		bOrientRotationToMovement = true;
+		ClimbBase.Reset();
+		CurrentHandhold.Reset();
+		TargetHandhold.Reset();
+		CornerTurn.bActive = false;
+		if (bAcceptClientPositionOverridden)
+		{
+			bServerAcceptClientAuthoritativePosition = bAcceptClientPositionBeforeClimb;
+			bAcceptClientPositionOverridden = false;
+		}
+		ClimbValidationPatch.bValid = false;
+		LastClimbExitTime = GetWorld()->GetTimeSeconds();
 		StopMovementImmediately();
 		OnExitClimbStateDelegate.ExecuteIfBound();
+
+		//climb mode was changed from outside of the state machine
+		if (ClimbState == EClimbState::Climbing || ClimbState == EClimbState::Hanging)
+		{
+			DispatchClimbEvent(EClimbEvent::StopClimb);
+		}
+	}
+
+	//falling may still be caught, anything else ends the climb so Exiting can't get stuck
+	const bool bLeftClimbMovement {MovementMode != MOVE_Falling && MovementMode != MOVE_Custom && MovementMode != MOVE_None};
+	if (bLeftClimbMovement && ClimbState != EClimbState::Idle)
+	{
+		DispatchClimbEvent(EClimbEvent::Landed);
 	}
 }
 
 void UCLSMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
 {
+	CSV_SCOPED_TIMING_STAT(Climbing, PhysCustom);
+
+#if CLS_WITH_CLIMB_TELEMETRY
+	const uint64 physCustomStartCycles {FPlatformTime::Cycles64()};
+	ON_SCOPE_EXIT
+	{
+		FClimbSessionTelemetry::Get().AddPhysCustomTime(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - physCustomStartCycles));
+	};
+#endif
+
 	Super::PhysCustom(deltaTime,Iterations);
 
 	if (IsClimbing())
@@ -87,14 +307,42 @@ void UCLSMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
 			return;
 		}
 
-		//Process all the climable surfaces info
-		TraceClimbSurfaces(true);
-		GetClimbSurfaceInfo();
+		//handholds are indexed, no physics queries needed. Destroyed holds are still handled there, not by wall traces
+		if (!CurrentHandhold.IsExplicitlyNull() || !TargetHandhold.IsExplicitlyNull())
+		{
+			PhysHandholdClimb(deltaTime);
+			return;
+		}
+
+		//hanging character moves along extracted ledge, no climb surface traces
+		if (ClimbState == EClimbState::Hanging)
+		{
+			PhysLedgeHang(deltaTime);
+			return;
+		}
+
+		//corners are detected before averaged surface normal starts to flip
+		if (CornerTurn.bActive || (ClimbState == EClimbState::Climbing && TryStartCornerTurn()))
+		{
+			PhysCornerTurn(deltaTime);
+			return;
+		}
+
+		//Process all the climable surfaces info. Trace only when cached contact on the base is no longer valid
+		if (!UpdateClimbSurfaceFromBase(deltaTime) && !UpdateClimbSurfaceFromValidationPatch())
+		{
+			TraceClimbSurfaces();
+			GetClimbSurfaceInfo();
+			UpdateClimbBase();
+		}
+
+		//transitions played in climb mode (vault) are driven by root motion only
+		const bool bFreeClimbing {ClimbState == EClimbState::Climbing};
 
 		//Check if we should stop climbing
-		if (ShouldStopClimbing() || IsFloorReached())
+		if (bFreeClimbing && (ShouldStopClimbing() || IsFloorReached()))
 		{
-			EndClimbing();
+			DispatchClimbEvent(EClimbEvent::StopClimb);
 			return;
 		}
 
@@ -109,64 +357,152 @@ void UCLSMovementComponent::PhysCustom(float deltaTime, int32 Iterations)
 
 		ApplyRootMotionToVelocity(deltaTime);
 
-		FVector OldLocation = UpdatedComponent->GetComponentLocation();
-		const FVector Adjusted = Velocity * deltaTime;
-		FHitResult Hit(1.f);
-
-		SafeMoveUpdatedComponent(Adjusted, GetClimbRotation(deltaTime), true, Hit);
+		MoveAlongClimbSurface(deltaTime);
 
-		if (Hit.Time < 1.f)
+		if (bFreeClimbing && IsLedgeReached())
 		{
-			//adjust and try again
-			HandleImpact(Hit, deltaTime, Adjusted);
-			SlideAlongSurface(Adjusted, (1.f - Hit.Time), Hit.Normal, Hit, true);
+			if (!bHangOnLedgeReached || !TryGrabLedge())
+			{
+				DispatchClimbEvent(EClimbEvent::LedgeReached);
+			}
 		}
+	}
+}
 
-		if (!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+bool UCLSMovementComponent::QueryClimbContacts(const FVector& QueryLocation, TArray<FClimbContact>& OutContacts, const UCLSClimbDataSubsystem* BakedClimbData /*= nullptr*/)
+{
+	/*
+		Overlap instead of a zero length sweep: broad phase + overlap test only,
+		then contact point and normal are computed per primitive from the minimum translation distance
+	*/
+
+	OutContacts.Reset();
+
+	const FCollisionShape queryShape {FCollisionShape::MakeCapsule(ClimbCapsuleTraceRadius, ClimbCapsuleTraceHalfHeight)};
+	const FCollisionQueryParams queryParams {SCENE_QUERY_STAT(ClimbContactQuery), false, CharacterOwner};
+
+	TArray<FOverlapResult> overlaps;
+	ClimbOverlapMulti(overlaps, QueryLocation, FQuat::Identity, queryShape, queryParams);
+	CountClimbQueries(1);
+
+	//distance from capsule center to the centers of its hemispheres
+	const float capsuleSegmentHalfLength {FMath::Max(0.f, ClimbCapsuleTraceHalfHeight - ClimbCapsuleTraceRadius)};
+
+	for (const FOverlapResult& overlap : overlaps)
+	{
+		UPrimitiveComponent* overlappedPrimitive {overlap.GetComponent()};
+		if (!IsValid(overlappedPrimitive) || (BakedClimbData && BakedClimbData->IsBakedComponent(overlappedPrimitive)))
 		{
-			Velocity = (UpdatedComponent->GetComponentLocation() - OldLocation) / deltaTime;
+			continue;
 		}
 
-		SnapToClimable(deltaTime);
+		FClimbContact contact;
+		contact.Component = overlappedPrimitive;
+
+		FMTDResult mtdResult;
+		if (overlappedPrimitive->ComputePenetration(mtdResult, queryShape, QueryLocation, FQuat::Identity))
+		{
+			//deepest point of the capsule along the penetration direction, pushed back to the surface
+			const FVector capsuleSupportPoint {QueryLocation + FVector::UpVector * FMath::Sign(-mtdResult.Direction.Z) * capsuleSegmentHalfLength - mtdResult.Direction * ClimbCapsuleTraceRadius};
 
-		if (IsLedgeReached())
+			contact.Normal = mtdResult.Direction;
+			contact.PenetrationDepth = mtdResult.Distance;
+			contact.Location = capsuleSupportPoint + mtdResult.Direction * mtdResult.Distance;
+		}
+		else
 		{
-			EndClimbing();
-			PlayClimbMontage(ClimbToLedge);
+			//shape only touches the primitive, fallback to closest point
+			FVector closestPoint;
+			if (overlappedPrimitive->GetClosestPointOnCollision(QueryLocation, closestPoint) <= 0.f)
+			{
+				continue;
+			}
+
+			contact.Normal = (QueryLocation - closestPoint).GetSafeNormal();
+			contact.Location = closestPoint;
 		}
+
+		OutContacts.Add(contact);
 	}
+
+#if CLS_WITH_TRACE_RECORDER
+	const FClimbContact* firstContact {OutContacts.IsEmpty() ? nullptr : &OutContacts[0]};
+	TraceRecorder.RecordOverlap(EClimbQueryType::ContactOverlap, QueryLocation, queryShape, OutContacts.Num(),
+		firstContact ? firstContact->Location : FVector::ZeroVector, firstContact ? firstContact->Normal : FVector::ZeroVector);
+#endif
+
+	return !OutContacts.IsEmpty();
 }
 
-TArray <FHitResult> UCLSMovementComponent::DoCapsuleTraceMultiByObject(const FVector& TraceStart, const FVector& TraceEnd, bool bShowDebug, bool bShowOneFrame)
+FHitResult UCLSMovementComponent::DoClimbLineTraceSingle(const FVector& TraceStart, const FVector& TraceEnd)
 {
-	TArray<FHitResult> CapsuleHitResults;
+	FHitResult LineTraceSingleResult;
+	CountClimbQueries(1);
 
-	EDrawDebugTrace::Type drawDebugType = EDrawDebugTrace::Type::None;
-	if (bShowDebug)
+	if (ClimbQueryFilter == EClimbQueryFilter::ClimbableChannel)
+	{
+		UKismetSystemLibrary::LineTraceSingle(this, TraceStart, TraceEnd, UEngineTypes::ConvertToTraceType(ECC_Climbable),
+			false, TArray<AActor*>(), EDrawDebugTrace::None, LineTraceSingleResult, true);
+	}
+	else
 	{
-		drawDebugType = bShowOneFrame ? EDrawDebugTrace::Type::ForOneFrame : EDrawDebugTrace::Type::ForDuration;
+		UKismetSystemLibrary::LineTraceSingleForObjects(this, TraceStart, TraceEnd, ClimbSurfaceTypes,
+			false, TArray<AActor*>(), EDrawDebugTrace::None, LineTraceSingleResult, true);
 	}
 
-	UKismetSystemLibrary::CapsuleTraceMultiForObjects(this, TraceStart, TraceEnd, ClimbCapsuleTraceRadius, ClimbCapsuleTraceHalfHeight, ClimbSurfaceTypes,
-		false, TArray<AActor*>(), drawDebugType, CapsuleHitResults, true);
+#if CLS_WITH_TRACE_RECORDER
+	TraceRecorder.RecordLineTrace(EClimbQueryType::LineTrace, TraceStart, TraceEnd, LineTraceSingleResult);
+#endif
 
-	return CapsuleHitResults;
+	return LineTraceSingleResult;
 }
 
-FHitResult UCLSMovementComponent::DoLineTraceSingleByObject(const FVector& TraceStart, const FVector& TraceEnd, bool bShowDebug, bool bShowOneFrame)
+bool UCLSMovementComponent::ClimbOverlapMulti(TArray<FOverlapResult>& OutOverlaps, const FVector& Location, const FQuat& Rotation, const FCollisionShape& Shape, const FCollisionQueryParams& Params) const
 {
-	FHitResult LineTraceSingleResult;
+	if (ClimbQueryFilter == EClimbQueryFilter::ClimbableChannel)
+	{
+		return GetWorld()->OverlapMultiByChannel(OutOverlaps, Location, Rotation, ECC_Climbable, Shape, Params);
+	}
 
-	EDrawDebugTrace::Type drawDebugType = EDrawDebugTrace::Type::None;
-	if (bShowDebug)
+	return GetWorld()->OverlapMultiByObjectType(OutOverlaps, Location, Rotation, FCollisionObjectQueryParams(ClimbSurfaceTypes), Shape, Params);
+}
+
+bool UCLSMovementComponent::ClimbOverlapAny(const FVector& Location, const FQuat& Rotation, const FCollisionShape& Shape, const FCollisionQueryParams& Params) const
+{
+	CountClimbQueries(1);
+
+	const bool bOverlapping {ClimbQueryFilter == EClimbQueryFilter::ClimbableChannel
+		? GetWorld()->OverlapAnyTestByChannel(Location, Rotation, ECC_Climbable, Shape, Params)
+		: GetWorld()->OverlapAnyTestByObjectType(Location, Rotation, FCollisionObjectQueryParams(ClimbSurfaceTypes), Shape, Params)};
+
+#if CLS_WITH_TRACE_RECORDER
+	TraceRecorder.RecordOverlap(EClimbQueryType::OverlapTest, Location, Shape, bOverlapping ? 1 : 0);
+#endif
+
+	return bOverlapping;
+}
+
+bool UCLSMovementComponent::CanClimbPrimitive(const UPrimitiveComponent* Primitive) const
+{
+	if (!IsValid(Primitive) || !Primitive->IsQueryCollisionEnabled())
 	{
-		drawDebugType = bShowOneFrame ? EDrawDebugTrace::Type::ForOneFrame : EDrawDebugTrace::Type::ForDuration;
+		return false;
 	}
 
-	UKismetSystemLibrary::LineTraceSingleForObjects(this, TraceStart, TraceEnd, ClimbSurfaceTypes,
-		false, TArray<AActor*>(), drawDebugType, LineTraceSingleResult, true);
-	
-	return LineTraceSingleResult;
+	if (ClimbQueryFilter == EClimbQueryFilter::ClimbableChannel)
+	{
+		return Primitive->GetCollisionResponseToChannel(ECC_Climbable) == ECR_Block;
+	}
+
+	return ClimbSurfaceTypes.Contains(UEngineTypes::ConvertToObjectType(Primitive->GetCollisionObjectType()));
+}
+
+void UCLSMovementComponent::SetComponentClimbable(UPrimitiveComponent* Component, bool bClimbable)
+{
+	if (IsValid(Component))
+	{
+		Component->SetCollisionResponseToChannel(ECC_Climbable, bClimbable ? ECR_Block : ECR_Ignore);
+	}
 }
 
 #pragma endregion
@@ -177,14 +513,32 @@ void UCLSMovementComponent::ToggleClimbing(bool bEnable)
 {
 	if (bEnable)
 	{
-		if (CanStartClimbing())
+		//don't interrupt any animations
+		if (IsPlayingClimbTransition())
+		{
+			return;
+		}
+
+		if (UCLSHandholdComponent* startHandhold {FindStartHandhold()})
+		{
+			CurrentHandhold = startHandhold;
+			CurrentClimableSurfLocation = startHandhold->GetComponentLocation();
+			CurrentClimableSurfNormal = startHandhold->GetHoldNormal();
+
+			//entered state needs the hold, drop it if climbing couldn't start
+			if (!DispatchClimbEvent(EClimbEvent::StartClimb))
+			{
+				CurrentHandhold = nullptr;
+			}
+		}
+		else if (CanStartClimbing())
 		{
 			//Enter the climb state after transition anim finished
-			PlayClimbMontage(IdleToClimb);
+			DispatchClimbEvent(EClimbEvent::StartClimb);
 		}
 		else if (CanStartDescending())
 		{
-			PlayClimbMontage(IdleToLedge);
+			DispatchClimbEvent(EClimbEvent::StartDescend);
 		}
 		else
 		{
@@ -196,18 +550,48 @@ void UCLSMovementComponent::ToggleClimbing(bool bEnable)
 			{
 				StartVaulting(vaultStart, vaultEnd);
 			}
+#if CLS_WITH_CLIMB_TELEMETRY
+			else
+			{
+				FClimbSessionTelemetry::Get().AddFailedClimbAttempt();
+			}
+#endif
 		}
 	}
 
 	if (!bEnable)
 	{
-		EndClimbing();
+		bClimbReleasedByPlayer = DispatchClimbEvent(EClimbEvent::StopClimb);
+	}
+}
+
+FClimbTraversalOptions UCLSMovementComponent::EvaluateTraversalOptions()
+{
+	FClimbTraversalOptions options;
+
+	//detection writes climb contacts, don't touch them while climbing
+	if (IsClimbing() || ClimbState != EClimbState::Idle)
+	{
+		return options;
 	}
+
+	options.bCanClimb = CanStartClimbing();
+	options.bCanDescend = CanStartDescending();
+	Tie(options.bCanVault, options.VaultStart, options.VaultEnd) = CanVault();
+
+	return options;
 }
 
 bool UCLSMovementComponent::CanStartClimbing()
 {
-	return TraceClimbSurfaces(true,false) && TraceFromEyes(100,true,false).bBlockingHit && !IsFalling();
+	if (IsFalling() || !TraceClimbSurfaces() || !TraceFromEyes(100).bBlockingHit)
+	{
+		return false;
+	}
+
+	//entering transition targets this wall, not the one from the previous climb
+	GetClimbSurfaceInfo();
+	return true;
 }
 
 bool UCLSMovementComponent::CanStartDescending()
@@ -238,7 +622,7 @@ bool UCLSMovementComponent::CanStartDescending()
 
 	const FVector Trace2Start { Trace1HitResult.TraceEnd };
 	const FVector Trace2End{ Trace2Start + FVector::DownVector * TRACE2_HEIGHT };
-	FHitResult Trace2HitResult{ DoLineTraceSingleByObject(Trace2Start,Trace2End,false,true) };
+	FHitResult Trace2HitResult{ DoClimbLineTraceSingle(Trace2Start,Trace2End) };
 
 	if (Trace2HitResult.bBlockingHit)
 	{
@@ -247,10 +631,11 @@ bool UCLSMovementComponent::CanStartDescending()
 
 	const FVector Trace3Start{ Trace2HitResult.TraceEnd };
 	const FVector Trace3End{ Trace3Start + -UpdatedComponent->GetForwardVector() * TRACE3_LENGTH };
-	FHitResult Trace3HitResult{ DoLineTraceSingleByObject(Trace3Start,Trace3End,false,true) };
+	FHitResult Trace3HitResult{ DoClimbLineTraceSingle(Trace3Start,Trace3End) };
 
 	if (Trace3HitResult.bBlockingHit)
 	{
+		LastDescendLedgeLocation = Trace3HitResult.ImpactPoint + Trace3HitResult.ImpactNormal * CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius();
 		return true;
 	}
 
@@ -277,6 +662,15 @@ TTuple<bool, FVector, FVector> UCLSMovementComponent::CanVault()
 	const float HORIZONTAL_STEP {100.f};
 	const float MAX_VAULT_DISTANCE {500.f};
 
+	const UCLSClimbDataSubsystem* climbDataSubsystem {GetWorld()->GetSubsystem<UCLSClimbDataSubsystem>()};
+	FVector bakedVaultStart;
+	FVector bakedVaultEnd;
+	if (climbDataSubsystem && climbDataSubsystem->HasClimbData() && climbDataSubsystem->FindVaultSpan(componentLocation, forwardVec, HORIZONTAL_STEP,
+		VERTICAL_OFFSET - TRACE_DISTANCE_VAULT_SURFACE, VERTICAL_OFFSET, bakedVaultStart, bakedVaultEnd))
+	{
+		return MakeTuple(true, bakedVaultStart, bakedVaultEnd);
+	}
+
 	/*
 		We perform two traces - for vaulting surface and floor
 		If for first trace (i=1) both traces returns true - then first trace (vault surface trace) returns valid vault start location
@@ -290,10 +684,10 @@ TTuple<bool, FVector, FVector> UCLSMovementComponent::CanVault()
 	{
 		const FVector traceStart { componentLocation + upVec * VERTICAL_OFFSET + forwardVec * HORIZONTAL_STEP * i};
 		FVector traceSurfaceEnd {traceStart + downVec * TRACE_DISTANCE_VAULT_SURFACE };
-		FHitResult vaultSurfTrace {DoLineTraceSingleByObject(traceStart, traceSurfaceEnd, false,false)};
+		FHitResult vaultSurfTrace {DoClimbLineTraceSingle(traceStart, traceSurfaceEnd)};
 
 		traceSurfaceEnd = traceStart + downVec * TRACE_DISTANCE_FLOOR;
-		FHitResult floorSurfTrace {DoLineTraceSingleByObject(traceStart, traceSurfaceEnd, false,false)};
+		FHitResult floorSurfTrace {DoClimbLineTraceSingle(traceStart, traceSurfaceEnd)};
 
 		//check if we have a valid start vault location
 		FVector startVault;
@@ -329,24 +723,34 @@ void UCLSMovementComponent::SetMotionWarpTarget(FName TargetName, const FVector&
 	motionWarpingComponent->AddOrUpdateWarpTargetFromLocation(TargetName, TargetValue);
 }
 
-bool UCLSMovementComponent::TraceClimbSurfaces(bool bShowDebug /*= false*/, bool bShowOneFrame /*= true*/)
+bool UCLSMovementComponent::TraceClimbSurfaces()
 {
 	const FVector StratOffset{ UpdatedComponent->GetForwardVector() * 30.f };
-	const FVector StartTrace{ UpdatedComponent->GetComponentLocation() + StratOffset };
-	const FVector EndTrace = StartTrace + UpdatedComponent->GetForwardVector();
-	ClimbTraceResults = DoCapsuleTraceMultiByObject(StartTrace, EndTrace, bShowDebug, bShowOneFrame);
+	const FVector QueryLocation{ UpdatedComponent->GetComponentLocation() + StratOffset };
 
-	return !ClimbTraceResults.IsEmpty();
+	const UCLSClimbDataSubsystem* climbDataSubsystem {GetWorld()->GetSubsystem<UCLSClimbDataSubsystem>()};
+	if (climbDataSubsystem == nullptr || !climbDataSubsystem->HasClimbData())
+	{
+		return QueryClimbContacts(QueryLocation, ClimbContacts);
+	}
+
+	//baked data answers for primitives it was built from, physics for moving and not baked ones
+	TArray<FClimbContact> bakedContacts;
+	climbDataSubsystem->FindClimbContacts(QueryLocation, ClimbCapsuleTraceRadius, ClimbCapsuleTraceHalfHeight, bakedContacts);
+	QueryClimbContacts(QueryLocation, ClimbContacts, climbDataSubsystem);
+	ClimbContacts.Append(bakedContacts);
+
+	return !ClimbContacts.IsEmpty();
 }
 
-FHitResult UCLSMovementComponent::TraceFromEyes(float TraceDistance, float TraceStartOffset /*= 0*/, bool bShowDebug /*= false*/, bool bShowOneFrame /*= true*/)
+FHitResult UCLSMovementComponent::TraceFromEyes(float TraceDistance, float TraceStartOffset /*= 0*/)
 {
 	const FVector ComponentLocation{ UpdatedComponent->GetComponentLocation()};
 	const FVector EyeHeightOffset{ UpdatedComponent->GetUpVector() * (CharacterOwner->BaseEyeHeight + TraceStartOffset)};
 	const FVector StartTraceLocation = ComponentLocation + EyeHeightOffset;
 	const FVector EndTraceLocation = StartTraceLocation + (UpdatedComponent->GetForwardVector() * TraceDistance);
 
-	return DoLineTraceSingleByObject(StartTraceLocation, EndTraceLocation, bShowDebug, bShowOneFrame);
+	return DoClimbLineTraceSingle(StartTraceLocation, EndTraceLocation);
 }
 
 bool UCLSMovementComponent::IsClimbing() const
@@ -366,16 +770,19 @@ void UCLSMovementComponent::StartClimbing()
 
 void UCLSMovementComponent::EndClimbing()
 {
-	SetMovementMode(MOVE_Falling);
+	if (IsClimbing())
+	{
+		SetMovementMode(MOVE_Falling);
+	}
 }
 
 void UCLSMovementComponent::StartVaulting(const FVector& StartVault, const FVector& EndVault)
 {
 	SetMotionWarpTarget(FName(TEXT("VaultStartLocation")), StartVault);
 	SetMotionWarpTarget(FName(TEXT("VaultEndLocation")), EndVault);
+	ClimbTransitionWarpTarget = EndVault + UpdatedComponent->GetUpVector() * CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight();
 	
-	StartClimbing();
-	PlayClimbMontage(Vault);
+	DispatchClimbEvent(EClimbEvent::StartVault);
 }
 
 void UCLSMovementComponent::GetClimbSurfaceInfo()
@@ -383,25 +790,110 @@ void UCLSMovementComponent::GetClimbSurfaceInfo()
 	CurrentClimableSurfLocation = FVector::ZeroVector;
 	CurrentClimableSurfNormal = FVector::ZeroVector;
 
-	if (ClimbTraceResults.IsEmpty())
+	if (ClimbContacts.IsEmpty())
 	{
 		return;
 	}
 
-	for (const FHitResult& tracedHitResult : ClimbTraceResults)
+	for (const FClimbContact& contact : ClimbContacts)
 	{
-		CurrentClimableSurfLocation += tracedHitResult.ImpactPoint;
-		CurrentClimableSurfNormal += tracedHitResult.ImpactNormal;
+		CurrentClimableSurfLocation += contact.Location;
+		CurrentClimableSurfNormal += contact.Normal;
 	}
 
-	CurrentClimableSurfLocation /= ClimbTraceResults.Num();
+	CurrentClimableSurfLocation /= ClimbContacts.Num();
 	CurrentClimableSurfNormal = CurrentClimableSurfNormal.GetSafeNormal();
 
 }
 
+void UCLSMovementComponent::UpdateClimbBase()
+{
+	ClimbBase.Reset();
+
+	if (ClimbContacts.IsEmpty())
+	{
+		return;
+	}
+
+	UPrimitiveComponent* newBase {ClimbContacts[0].Component.Get()};
+	const FName newBaseBoneName {NAME_None};
+
+	if (!IsValid(newBase))
+	{
+		return;
+	}
+
+	if (CharacterOwner->GetMovementBase() != newBase || CharacterOwner->GetBasedMovement().BoneName != newBaseBoneName)
+	{
+		CharacterOwner->SetBase(newBase, newBaseBoneName);
+	}
+
+	FVector baseLocation;
+	FQuat baseQuat;
+	if (!MovementBaseUtility::GetMovementBaseTransform(newBase, newBaseBoneName, baseLocation, baseQuat))
+	{
+		return;
+	}
+
+	const FTransform baseTransform {baseQuat, baseLocation};
+
+	ClimbBase = newBase;
+	ClimbBaseBoneName = newBaseBoneName;
+	ClimbBaseLocalSurfLocation = baseTransform.InverseTransformPositionNoScale(CurrentClimableSurfLocation);
+	ClimbBaseLocalSurfNormal = baseTransform.InverseTransformVectorNoScale(CurrentClimableSurfNormal);
+	ClimbBaseLocalCharLocation = baseTransform.InverseTransformPositionNoScale(UpdatedComponent->GetComponentLocation());
+	ClimbBaseVelocityAtValidation = MovementBaseUtility::GetMovementBaseVelocity(newBase, newBaseBoneName);
+	TimeSinceClimbSurfaceValidation = 0.f;
+}
+
+bool UCLSMovementComponent::UpdateClimbSurfaceFromBase(float DeltaTime)
+{
+	UPrimitiveComponent* climbBase {ClimbBase.Get()};
+
+	//base can be lost because of movement base logic (e.g. base destroyed)
+	if (climbBase == nullptr || climbBase != CharacterOwner->GetMovementBase() || ClimbContacts.IsEmpty())
+	{
+		return false;
+	}
+
+	TimeSinceClimbSurfaceValidation += DeltaTime;
+	if (TimeSinceClimbSurfaceValidation >= ClimbSurfaceRevalidationInterval)
+	{
+		return false;
+	}
+
+	//base was accelerated sharply, the cached contact can't be trusted anymore
+	const FVector baseVelocity {MovementBaseUtility::GetMovementBaseVelocity(climbBase, ClimbBaseBoneName)};
+	if (FVector::DistSquared(baseVelocity, ClimbBaseVelocityAtValidation) > FMath::Square(ClimbBaseVelocityChangeThreshold))
+	{
+		return false;
+	}
+
+	FVector baseLocation;
+	FQuat baseQuat;
+	if (!MovementBaseUtility::GetMovementBaseTransform(climbBase, ClimbBaseBoneName, baseLocation, baseQuat))
+	{
+		return false;
+	}
+
+	const FTransform baseTransform {baseQuat, baseLocation};
+
+	//we climbed too far from the traced contact, surface can change its shape there
+	const FVector localCharLocation {baseTransform.InverseTransformPositionNoScale(UpdatedComponent->GetComponentLocation())};
+	if (FVector::DistSquared(localCharLocation, ClimbBaseLocalCharLocation) > FMath::Square(ClimbSurfaceRevalidationDistance))
+	{
+		return false;
+	}
+
+	CurrentClimableSurfLocation = baseTransform.TransformPositionNoScale(ClimbBaseLocalSurfLocation);
+	CurrentClimableSurfNormal = baseTransform.TransformVectorNoScale(ClimbBaseLocalSurfNormal);
+
+	return true;
+}
+
 bool UCLSMovementComponent::ShouldStopClimbing() const
 {
-	if (ClimbTraceResults.IsEmpty())
+	if (ClimbContacts.IsEmpty())
 	{
 		return true;
 	}
@@ -417,21 +909,19 @@ bool UCLSMovementComponent::IsFloorReached()
 {
 	const FVector downDirection {-UpdatedComponent->GetUpVector()};
 	const FVector startOffset { downDirection * 50.f};
-	const FVector startTrace { UpdatedComponent->GetComponentLocation() + startOffset};
-	const FVector endTrace { startTrace + downDirection};
+	const FVector queryLocation { UpdatedComponent->GetComponentLocation() + startOffset};
 
-	TArray<FHitResult>traceHits	{DoCapsuleTraceMultiByObject(startTrace, endTrace,true,true)};
-
-	if (traceHits.IsEmpty())
+	TArray<FClimbContact> floorContacts;
+	if (!QueryClimbContacts(queryLocation, floorContacts))
 	{
 		return false;
 	}
 
-	for (const FHitResult& possibleHit : traceHits)
+	for (const FClimbContact& possibleFloor : floorContacts)
 	{
 		//filter out surfaces that are not horizontal
 		//check angle surface normal and vertical direction. If it is small - then surface is floor
-		const float dotProduct{ (float)FVector::DotProduct(possibleHit.ImpactNormal,FVector::UpVector) };
+		const float dotProduct{ (float)FVector::DotProduct(possibleFloor.Normal,FVector::UpVector) };
 		const float degree{ FMath::RadiansToDegrees(FMath::Acos(dotProduct)) };
 		const bool isMovingDown { GetUnrotatedClimbVelocity().Z < -10.f };
 
@@ -446,17 +936,24 @@ bool UCLSMovementComponent::IsFloorReached()
 
 bool UCLSMovementComponent::IsLedgeReached()
 {
-	FHitResult ledgeHitTrace {TraceFromEyes(100.f,80.f,true)};
+	return GetUnrotatedClimbVelocity().Z > 10.f && TraceLedgeTop();
+}
+
+bool UCLSMovementComponent::TraceLedgeTop()
+{
+	FHitResult ledgeHitTrace {TraceFromEyes(100.f,80.f)};
 
 	if (!ledgeHitTrace.bBlockingHit)
 	{
 		const FVector walkingSurfaceTraceStart { ledgeHitTrace.TraceEnd};
 		const FVector walkingSurfaceTraceEnd{ walkingSurfaceTraceStart + FVector::DownVector * 100.f };
 
-		FHitResult walkingSurfaceHitResult {DoLineTraceSingleByObject(walkingSurfaceTraceStart,walkingSurfaceTraceEnd,false,true)};
+		FHitResult walkingSurfaceHitResult {DoClimbLineTraceSingle(walkingSurfaceTraceStart,walkingSurfaceTraceEnd)};
 
-		if (walkingSurfaceHitResult.bBlockingHit && GetUnrotatedClimbVelocity().Z > 10.f)
+		if (walkingSurfaceHitResult.bBlockingHit)
 		{
+			LastLedgeTopLocation = walkingSurfaceHitResult.ImpactPoint;
+			LastLedgeTopFrame = GFrameCounter;
 			return true;
 		}
 	}
@@ -478,45 +975,1369 @@ FQuat UCLSMovementComponent::GetClimbRotation(float DeltaTime) const
 	return FMath::QInterpTo(currentQuat,targetQuat,DeltaTime,5.f);
 }
 
-void UCLSMovementComponent::SnapToClimable(float DeltaTime)
+FVector UCLSMovementComponent::GetClimbSnapOffset(float DeltaTime) const
 {
 	const FVector currentLocation {UpdatedComponent->GetComponentLocation()};
-	const FVector forwardVec { UpdatedComponent->GetForwardVector()};
-	const FVector projectedCharToSurface {(CurrentClimableSurfLocation - currentLocation).ProjectOnTo(forwardVec)};
+	const float wallDistance {(float)FVector::DotProduct(currentLocation - CurrentClimableSurfLocation, CurrentClimableSurfNormal)};
 
-	//Vector that defines by how much we are going to move the component to snap to the wall
-	const FVector snapOffset {-CurrentClimableSurfNormal * projectedCharToSurface.Length()};
+	//only close the gap left between capsule and the wall, flush capsule doesn't move
+	const float desiredWallDistance {CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius() + ClimbWallGap};
+	const float maxSnapDistance {MaxClimbSpeed * DeltaTime};
+	const float snapDistance {FMath::Clamp(wallDistance - desiredWallDistance, -maxSnapDistance, maxSnapDistance)};
 
-	UpdatedComponent->MoveComponent(snapOffset * DeltaTime * MaxClimbSpeed, UpdatedComponent->GetComponentQuat(),true);
+	return -CurrentClimableSurfNormal * snapDistance;
 }
 
-void UCLSMovementComponent::PlayClimbMontage(UAnimMontage* AnimToPlay)
+void UCLSMovementComponent::MoveAlongClimbSurface(float DeltaTime)
 {
-	check(AnimToPlay != nullptr);
-	UAnimInstance* playerAnimInstance { GetCharacterOwner()->GetMesh()->GetAnimInstance() };
+	/*
+		Climb move and snap to the wall are resolved together:
+		displacement = tangential velocity + snap offset towards the surface, rotation = climb rotation.
+		One sweep for the whole displacement and one slide if we hit something
+	*/
 
-	//don't interrupt any animations
-	if (playerAnimInstance->IsAnyMontagePlaying())
+	const FVector oldLocation {UpdatedComponent->GetComponentLocation()};
+	const FVector adjusted {Velocity * DeltaTime + GetClimbSnapOffset(DeltaTime)};
+	FHitResult hit(1.f);
+
+	SafeMoveUpdatedComponent(adjusted, GetClimbRotation(DeltaTime), true, hit);
+	INC_DWORD_STAT(STAT_ClimbMoveSweeps);
+
+	if (hit.Time < 1.f)
 	{
-		return;
+		//adjust and try again, the climbed wall itself is not an impact
+		const bool bHitClimbedWall {hit.GetComponent() == ClimbBase.Get() || FVector::DotProduct(hit.Normal, CurrentClimableSurfNormal) > 0.95f};
+		if (!bHitClimbedWall)
+		{
+			HandleImpact(hit, DeltaTime, adjusted);
+		}
+		SlideAlongSurface(adjusted, (1.f - hit.Time), hit.Normal, hit, true);
+		INC_DWORD_STAT(STAT_ClimbMoveSweeps);
 	}
 
-	playerAnimInstance->Montage_Play(AnimToPlay);
-
+	if (!HasAnimRootMotion() && !CurrentRootMotion.HasOverrideVelocity())
+	{
+		//snap towards the wall is not a part of climb velocity
+		const FVector climbDelta {FVector::VectorPlaneProject(UpdatedComponent->GetComponentLocation() - oldLocation, CurrentClimableSurfNormal)};
+		Velocity = climbDelta / DeltaTime;
+	}
 }
 
-void UCLSMovementComponent::OnClimbMontageEnded(UAnimMontage* Montage, bool bInterrupted)
+void UCLSMovementComponent::PlayClimbMontage(const TSoftObjectPtr<UAnimMontage>& AnimToPlay)
 {
-	UAnimInstance* playerAnimInstance{ GetCharacterOwner()->GetMesh()->GetAnimInstance() };
-
-	if (Montage == IdleToClimb || Montage == IdleToLedge)
+	//don't interrupt any animations
+	if (IsPlayingClimbTransition())
 	{
-		StartClimbing();
+		ClimbTransitionWarpTarget.Reset();
+		return;
 	}
-	else
+
+	UAnimMontage* montageToPlay {GetClimbMontage(AnimToPlay)};
+	check(montageToPlay != nullptr);
+
+	if (ShouldUseClimbTransitionTracks())
 	{
-		SetMovementMode(MOVE_Walking);
+		PlayClimbTransitionTrack(montageToPlay);
+		return;
+	}
+
+	ClimbTransitionWarpTarget.Reset();
+
+	UAnimInstance* playerAnimInstance { GetCharacterOwner()->GetMesh()->GetAnimInstance() };
+	playerAnimInstance->Montage_Play(montageToPlay);
+
+}
+
+TOptional<FVector> UCLSMovementComponent::GetClimbTransitionTarget(EClimbState Transition) const
+{
+	const UCapsuleComponent* capsule {CharacterOwner->GetCapsuleComponent()};
+
+	switch (Transition)
+	{
+	case EClimbState::Entering:
+		if (CurrentClimableSurfNormal.IsNearlyZero())
+		{
+			return {};
+		}
+		return CurrentClimableSurfLocation + CurrentClimableSurfNormal * capsule->GetScaledCapsuleRadius();
+
+	case EClimbState::Descending:
+		return LastDescendLedgeLocation;
+
+	case EClimbState::ToppingOut:
+		//ledge top is only known when it was found this frame
+		if (LastLedgeTopFrame != GFrameCounter)
+		{
+			return {};
+		}
+		return LastLedgeTopLocation + UpdatedComponent->GetUpVector() * capsule->GetScaledCapsuleHalfHeight();
+
+	case EClimbState::Vaulting:
+		//set by StartVaulting
+		return ClimbTransitionWarpTarget;
+
+	default:
+		return {};
+	}
+}
+
+TSoftObjectPtr<UAnimMontage> UCLSMovementComponent::SelectClimbTransition(EClimbState Transition, const TSoftObjectPtr<UAnimMontage>& DefaultMontage)
+{
+	SCOPE_CYCLE_COUNTER(STAT_ClimbTransitionSelection);
+
+	if (ClimbTransitionDatabase == nullptr || IsPlayingClimbTransition())
+	{
+		return DefaultMontage;
+	}
+
+	const TOptional<FVector> target {GetClimbTransitionTarget(Transition)};
+	if (!target.IsSet())
+	{
+		return DefaultMontage;
+	}
+
+	FClimbTransitionQuery query;
+	query.TargetTranslation = UpdatedComponent->GetComponentQuat().UnrotateVector(target.GetValue() - UpdatedComponent->GetComponentLocation());
+	query.Speed = Velocity.Size();
+
+	const FClimbTransitionClip* clip {ClimbTransitionDatabase->FindClosestClip(Transition, query)};
+	if (clip == nullptr)
+	{
+		return DefaultMontage;
+	}
+
+	//closest clip only ends near the target, warp it the rest of the way
+	SetMotionWarpTarget(UCLSClimbTransitionDatabase::WarpTargetName, target.GetValue());
+	ClimbTransitionWarpTarget = target;
+
+	return clip->Montage;
+}
+
+void UCLSMovementComponent::OnClimbMontageEnded(UAnimMontage* Montage, bool bInterrupted)
+{
+	const bool bIsClimbTransition {Montage != nullptr && (Montage == IdleToClimb.Get() || Montage == IdleToLedge.Get() || Montage == ClimbToLedge.Get() || Montage == Vault.Get()
+		|| (ClimbTransitionDatabase != nullptr && ClimbTransitionDatabase->ContainsMontage(Montage)))};
+
+	if (!bIsClimbTransition)
+	{
+		++SuppressedClimbEvents[(int32)EClimbEvent::TransitionFinished];
+		return;
+	}
+
+	DispatchClimbEvent(EClimbEvent::TransitionFinished);
+}
+
+#pragma endregion
+
+#pragma region ClimbMoveValidation
+
+bool UCLSMovementComponent::ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc, const FVector& RelativeClientLoc, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode)
+{
+	EMovementMode clientMode;
+	uint8 clientCustomMode;
+	uint8 clientGroundMode;
+	UnpackNetworkMovementMode(ClientMovementMode, clientMode, clientCustomMode, clientGroundMode);
+
+	//root motion transitions move faster than climbing and are checked the usual way
+	const bool bClientClimbing {clientMode == MOVE_Custom && clientCustomMode == (uint8)ECustomMovementMode::MOVE_Climb};
+	if (!bClientClimbing || !IsValidatingClimbMoves() || !ClimbValidationPatch.bValid || HasAnimRootMotion() || CurrentRootMotion.HasActiveRootMotionSources())
+	{
+		return Super::ServerCheckClientError(ClientTimeStamp, DeltaTime, Accel, ClientLoc, RelativeClientLoc, ClientMovementBase, ClientBaseBoneName, ClientMovementMode);
+	}
+
+	//client can't get further from the simulated move than climbing allows, whatever walls are around
+	const bool bWithinClimbReach {FVector::DistSquared(ClientLoc, UpdatedComponent->GetComponentLocation()) <= FMath::Square(MaxClimbSpeed * DeltaTime + ClimbValidationMoveTolerance)};
+
+	//moves on the cached patch cost nothing, one probe from server position when client leaves it
+	if (bWithinClimbReach && (IsInsideClimbValidationPatch(ClientLoc) || (ProbeClimbValidationPatch() && IsInsideClimbValidationPatch(ClientLoc))))
+	{
+		++NumAcceptedClimbMoves;
+		INC_DWORD_STAT(STAT_ClimbMovesAccepted);
+		return false;
+	}
+
+	++NumRejectedClimbMoves;
+	INC_DWORD_STAT(STAT_ClimbMovesRejected);
+	CSV_CUSTOM_STAT(Climbing, RejectedMoves, 1, ECsvCustomStatOp::Accumulate);
+	UE_LOG(LogClimbingSystem, Verbose, TEXT("%s: climb move at %s rejected"), *GetNameSafe(GetOwner()), *ClientLoc.ToString());
+
+	return true;
+}
+
+bool UCLSMovementComponent::IsValidatingClimbMoves() const
+{
+	return CVarClimbMoveValidation.GetValueOnGameThread() && CharacterOwner && CharacterOwner->HasAuthority() && !CharacterOwner->IsLocallyControlled();
+}
+
+bool UCLSMovementComponent::IsInsideClimbValidationPatch(const FVector& Location) const
+{
+	const FVector toLocation {Location - ClimbValidationPatch.Location};
+	const float wallDistance {(float)FVector::DotProduct(toLocation, ClimbValidationPatch.Normal)};
+	const float lateralDistanceSquared {(float)FVector::VectorPlaneProject(toLocation, ClimbValidationPatch.Normal).SizeSquared()};
+
+	return wallDistance >= 0.f && wallDistance <= ClimbValidationMaxWallDistance && lateralDistanceSquared <= FMath::Square(ClimbValidationPatchRadius);
+}
+
+bool UCLSMovementComponent::ProbeClimbValidationPatch()
+{
+	++NumClimbValidationProbes;
+	INC_DWORD_STAT(STAT_ClimbValidationProbes);
+
+	//probe from where the server put the character, client location is not trusted
+	const FVector location {UpdatedComponent->GetComponentLocation()};
+
+	//character faces the wall while climbing, forward also covers corner turns
+	const FVector probeDirection {UpdatedComponent->GetForwardVector()};
+	const FHitResult probeHit {DoClimbLineTraceSingle(location, location + probeDirection * ClimbValidationMaxWallDistance)};
+
+	if (!probeHit.bBlockingHit || probeHit.bStartPenetrating)
+	{
+		return false;
+	}
+
+	ClimbValidationPatch.Location = probeHit.ImpactPoint;
+	ClimbValidationPatch.Normal = probeHit.ImpactNormal;
+	ClimbValidationPatch.Component = probeHit.GetComponent();
+	return true;
+}
+
+bool UCLSMovementComponent::UpdateClimbSurfaceFromValidationPatch()
+{
+	if (!ClimbValidationPatch.bValid || !IsValidatingClimbMoves() || !IsInsideClimbValidationPatch(UpdatedComponent->GetComponentLocation()))
+	{
+		return false;
+	}
+
+	//patch is in world space, moving surfaces are traced and tracked as climb base
+	const UPrimitiveComponent* patchComponent {ClimbValidationPatch.Component.Get()};
+	if (patchComponent == nullptr || patchComponent->Mobility == EComponentMobility::Movable)
+	{
+		return false;
+	}
+
+	CurrentClimableSurfLocation = FVector::PointPlaneProject(UpdatedComponent->GetComponentLocation(), ClimbValidationPatch.Location, ClimbValidationPatch.Normal);
+	CurrentClimableSurfNormal = ClimbValidationPatch.Normal;
+
+	//patch stands in for traced contacts, so stop checks see a surface and the base stays set
+	ClimbContacts.SetNum(1);
+	ClimbContacts[0] = FClimbContact {CurrentClimableSurfLocation, CurrentClimableSurfNormal, 0.f, ClimbValidationPatch.Component};
+	UpdateClimbBase();
+	return true;
+}
+
+#pragma endregion
+
+#pragma region CornerTurn
+
+bool UCLSMovementComponent::TryStartCornerTurn()
+{
+	if (!bEnableCornerTurns || HasAnimRootMotion() || CurrentRootMotion.HasOverrideVelocity())
+	{
+		return false;
+	}
+
+	const FVector wallNormal {FVector::VectorPlaneProject(CurrentClimableSurfNormal, FVector::UpVector).GetSafeNormal()};
+	const FVector lateralVelocity {FVector::VectorPlaneProject(FVector::VectorPlaneProject(Velocity, wallNormal), FVector::UpVector)};
+	if (wallNormal.IsNearlyZero() || lateralVelocity.SizeSquared() < FMath::Square(10.f))
+	{
+		return false;
+	}
+
+	const FVector location {UpdatedComponent->GetComponentLocation()};
+	const FVector lateralDirection {lateralVelocity.GetSafeNormal()};
+	const float capsuleRadius {CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius()};
+	const float wallDistance {(float)FVector::DotProduct(location - CurrentClimableSurfLocation, wallNormal)};
+
+	//inner corner: another wall right next to the capsule side
+	const FHitResult sideHit {DoClimbLineTraceSingle(location, location + lateralDirection * (capsuleRadius + CornerProbeDistance))};
+	if (sideHit.bBlockingHit)
+	{
+		return BeginCornerTurn(sideHit.ImpactNormal, sideHit.ImpactPoint, false);
+	}
+
+	//outer corner: wall ends in front of the capsule edge, new wall is found by probing back around the edge
+	const FVector capsuleEdge {location + lateralDirection * capsuleRadius};
+	const FHitResult edgeHit {DoClimbLineTraceSingle(capsuleEdge, capsuleEdge - wallNormal * (wallDistance + CornerProbeDistance))};
+	if (edgeHit.bBlockingHit)
+	{
+		return false;
+	}
+
+	const FVector wrapStart {capsuleEdge - wallNormal * (wallDistance + CornerProbeDistance * 0.5f)};
+	const FHitResult wrapHit {DoClimbLineTraceSingle(wrapStart, wrapStart - lateralDirection * (capsuleRadius + CornerProbeDistance))};
+
+	return wrapHit.bBlockingHit && BeginCornerTurn(wrapHit.ImpactNormal, wrapHit.ImpactPoint, true);
+}
+
+bool UCLSMovementComponent::BeginCornerTurn(const FVector& NewWallNormal, const FVector& NewWallLocation, bool bOuterCorner)
+{
+	/*
+		Inner corner: arc is tangent to both walls offset by current wall distance,
+		it starts at character location facing old wall and ends at the same distance from the new wall.
+		Center = location + oldNormal * radius, rotating start offset by the angle between normals maps oldNormal to newNormal.
+		Outer corner: arc is centered on the edge where both walls meet, radius is current wall distance.
+		Character is usually a bit before the edge, that gap is faded out along the arc
+	*/
+
+	const FVector oldNormal {FVector::VectorPlaneProject(CurrentClimableSurfNormal, FVector::UpVector).GetSafeNormal()};
+	const FVector newNormal {FVector::VectorPlaneProject(NewWallNormal, FVector::UpVector).GetSafeNormal()};
+	const float normalsDot {(float)FVector::DotProduct(oldNormal, newNormal)};
+
+	if (newNormal.IsNearlyZero() || normalsDot > FMath::Cos(FMath::DegreesToRadians(CornerMinAngle)) || normalsDot < -0.95f)
+	{
+		return false;
+	}
+
+	const FVector location {UpdatedComponent->GetComponentLocation()};
+	const float oldWallDistance {(float)FVector::DotProduct(location - CurrentClimableSurfLocation, oldNormal)};
+	const float newWallDistance {(float)FVector::DotProduct(location - NewWallLocation, newNormal)};
+	float arcRadius {0.f};
+
+	if (bOuterCorner)
+	{
+		//edge = location + a * oldNormal + b * newNormal lying on both wall planes
+		const float determinant {1.f - FMath::Square(normalsDot)};
+		const float a {(normalsDot * newWallDistance - oldWallDistance) / determinant};
+		const float b {(normalsDot * oldWallDistance - newWallDistance) / determinant};
+
+		arcRadius = oldWallDistance;
+		CornerTurn.ArcCenter = location + oldNormal * a + newNormal * b;
+		CornerTurn.StartOffset = oldNormal * arcRadius;
+		CornerTurn.StartGap = location - (CornerTurn.ArcCenter + CornerTurn.StartOffset);
+	}
+	else
+	{
+		arcRadius = (newWallDistance - oldWallDistance) / (1.f - normalsDot);
+		CornerTurn.ArcCenter = location + oldNormal * arcRadius;
+		CornerTurn.StartOffset = location - CornerTurn.ArcCenter;
+		CornerTurn.StartGap = FVector::ZeroVector;
+	}
+
+	CornerTurn.Angle = FMath::Atan2(FVector::CrossProduct(oldNormal, newNormal).Z, normalsDot);
+	CornerTurn.TargetRotation = FRotationMatrix::MakeFromX(-newNormal).ToQuat();
+
+	//arc moves without sweeps, so make sure its second half and end pose are free once here, first half runs along the current wall
+	const FVector midLocation {CornerTurn.ArcCenter + CornerTurn.StartOffset.RotateAngleAxis(FMath::RadiansToDegrees(CornerTurn.Angle * 0.5f), FVector::UpVector) + CornerTurn.StartGap * 0.5f};
+	const FVector endLocation {CornerTurn.ArcCenter + CornerTurn.StartOffset.RotateAngleAxis(FMath::RadiansToDegrees(CornerTurn.Angle), FVector::UpVector)};
+
+	FCollisionQueryParams queryParams {SCENE_QUERY_STAT(ClimbCornerTurn), false, CharacterOwner};
+	FCollisionResponseParams responseParams;
+	InitCollisionParams(queryParams, responseParams);
+	CountClimbQueries(1);
+
+	if (GetWorld()->SweepTestByChannel(midLocation, endLocation, CornerTurn.TargetRotation, UpdatedComponent->GetCollisionObjectType(),
+		GetPawnCapsuleCollisionShape(SHRINK_RadiusCustom, 2.f), queryParams, responseParams))
+	{
+		return false;
+	}
+
+	CornerTurn.TargetNormal = newNormal;
+	CornerTurn.TargetSurfaceLocation = NewWallLocation;
+	CornerTurn.StartRotation = UpdatedComponent->GetComponentQuat();
+
+	//turning in place still takes some time
+	const float capsuleRadius {CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius()};
+	CornerTurn.ArcLength = FMath::Max(FMath::Abs(CornerTurn.Angle * arcRadius), FMath::Abs(CornerTurn.Angle) * capsuleRadius);
+	CornerTurn.Distance = 0.f;
+	CornerTurn.bActive = true;
+
+	return true;
+}
+
+void UCLSMovementComponent::PhysCornerTurn(float DeltaTime)
+{
+	CornerTurn.Distance = FMath::Min(CornerTurn.Distance + MaxClimbSpeed * DeltaTime, CornerTurn.ArcLength);
+	const float turnAlpha {CornerTurn.ArcLength > KINDA_SMALL_NUMBER ? CornerTurn.Distance / CornerTurn.ArcLength : 1.f};
+
+	const FVector targetLocation {CornerTurn.ArcCenter + CornerTurn.StartOffset.RotateAngleAxis(FMath::RadiansToDegrees(CornerTurn.Angle * turnAlpha), FVector::UpVector)
+		+ CornerTurn.StartGap * (1.f - turnAlpha)};
+	const FQuat targetRotation {FQuat::Slerp(CornerTurn.StartRotation, CornerTurn.TargetRotation, turnAlpha)};
+
+	const FVector oldLocation {UpdatedComponent->GetComponentLocation()};
+	MoveUpdatedComponent(targetLocation - oldLocation, targetRotation, false);
+	Velocity = (UpdatedComponent->GetComponentLocation() - oldLocation) / DeltaTime;
+
+	if (turnAlpha >= 1.f)
+	{
+		//continue regular climbing on the new wall
+		CornerTurn.bActive = false;
+		CurrentClimableSurfNormal = CornerTurn.TargetNormal;
+		CurrentClimableSurfLocation = CornerTurn.TargetSurfaceLocation;
+		ClimbBase.Reset();
+	}
+}
+
+#pragma endregion
+
+#pragma region LedgeHang
+
+bool UCLSMovementComponent::TryGrabLedge()
+{
+	//edge is where wall plane meets ledge top
+	FVector edgePoint {FVector::PointPlaneProject(UpdatedComponent->GetComponentLocation(), CurrentClimableSurfLocation, CurrentClimableSurfNormal)};
+	edgePoint.Z = LastLedgeTopLocation.Z;
+
+	const FVector wallNormal {FVector::VectorPlaneProject(CurrentClimableSurfNormal, FVector::UpVector).GetSafeNormal()};
+	if (wallNormal.IsNearlyZero() || !ExtractLedgeSpline(edgePoint, wallNormal))
+	{
+		return false;
+	}
+
+	//keep current offset from the edge so grabbing doesn't snap the character
+	const FVector edgeToCharacter {UpdatedComponent->GetComponentLocation() - LedgeSpline.Eval(LedgeDistance)};
+	LedgeHangOffset.X = FVector::DotProduct(edgeToCharacter, wallNormal);
+	LedgeHangOffset.Y = -edgeToCharacter.Z;
+
+	return DispatchClimbEvent(EClimbEvent::LedgeGrabbed);
+}
+
+bool UCLSMovementComponent::ProbeLedgePoint(const FVector& AlongLedgePoint, const FVector& WallNormal, FVector& OutEdgePoint)
+{
+	//vertical probe slightly behind the edge, ledge top must be walkable
+	const FVector probeInset {-WallNormal * 10.f};
+	const FVector probeStart {AlongLedgePoint + probeInset + FVector::UpVector * (LedgeMaxStepHeight + 10.f)};
+	const FVector probeEnd {AlongLedgePoint + probeInset - FVector::UpVector * (LedgeMaxStepHeight + 10.f)};
+
+	const FHitResult ledgeTopHit {DoClimbLineTraceSingle(probeStart, probeEnd)};
+	if (!ledgeTopHit.bBlockingHit || ledgeTopHit.bStartPenetrating || !IsWalkable(ledgeTopHit))
+	{
+		return false;
+	}
+
+	OutEdgePoint = FVector {AlongLedgePoint.X, AlongLedgePoint.Y, ledgeTopHit.ImpactPoint.Z};
+	return true;
+}
+
+bool UCLSMovementComponent::ExtractLedgeSpline(const FVector& EdgePoint, const FVector& WallNormal)
+{
+	/*
+		Ledge is extracted once on grab: points are probed along the edge in both directions
+		until ledge ends or changes height too much, then character moves along the spline without traces
+	*/
+
+	FVector grabPoint;
+	if (!ProbeLedgePoint(EdgePoint, WallNormal, grabPoint))
+	{
+		return false;
+	}
+
+	const FVector ledgeDirection {FVector::CrossProduct(FVector::UpVector, WallNormal).GetSafeNormal()};
+	const int32 maxSteps {FMath::FloorToInt32(LedgeExtractExtent / LedgeProbeStep)};
+
+	TArray<FVector> ledgePoints {grabPoint};
+	int32 grabPointIndex {0};
+
+	for (const float stepSign : {-1.f, 1.f})
+	{
+		FVector previousPoint {grabPoint};
+		for (int32 step = 1; step <= maxSteps; ++step)
+		{
+			FVector nextPoint;
+			if (!ProbeLedgePoint(previousPoint + ledgeDirection * stepSign * LedgeProbeStep, WallNormal, nextPoint) || FMath::Abs(nextPoint.Z - previousPoint.Z) > LedgeMaxStepHeight)
+			{
+				break;
+			}
+
+			if (stepSign < 0.f)
+			{
+				ledgePoints.Insert(nextPoint, 0);
+				++grabPointIndex;
+			}
+			else
+			{
+				ledgePoints.Add(nextPoint);
+			}
+			previousPoint = nextPoint;
+		}
+	}
+
+	LedgeSpline.Reset();
+	float distance {0.f};
+	for (int32 i = 0; i < ledgePoints.Num(); ++i)
+	{
+		distance += i > 0 ? FVector::Dist(ledgePoints[i - 1], ledgePoints[i]) : 0.f;
+		LedgeSpline.AddPoint(distance, ledgePoints[i]);
+
+		if (i == grabPointIndex)
+		{
+			LedgeDistance = distance;
+		}
+	}
+	LedgeSpline.AutoSetTangents();
+
+	LedgeLength = distance;
+	LedgeGrabNormal = WallNormal;
+
+	return true;
+}
+
+bool UCLSMovementComponent::ExtendLedgeSpline(bool bAtEnd)
+{
+	if (LedgeSpline.Points.IsEmpty())
+	{
+		return false;
+	}
+
+	const FVector endPoint {bAtEnd ? LedgeSpline.Points.Last().OutVal : LedgeSpline.Points[0].OutVal};
+	const float endDistance {bAtEnd ? LedgeLength : 0.f};
+	const FVector outwardDirection {(bAtEnd ? 1.f : -1.f) * LedgeSpline.EvalDerivative(endDistance).GetSafeNormal()};
+
+	FVector nextPoint;
+	if (!ProbeLedgePoint(endPoint + outwardDirection * LedgeProbeStep, GetLedgeNormal(endDistance), nextPoint) || FMath::Abs(nextPoint.Z - endPoint.Z) > LedgeMaxStepHeight)
+	{
+		return false;
+	}
+
+	const float stepLength {(float)FVector::Dist(endPoint, nextPoint)};
+
+	if (bAtEnd)
+	{
+		LedgeLength += stepLength;
+		LedgeSpline.AddPoint(LedgeLength, nextPoint);
+	}
+	else
+	{
+		//keys have to stay positive, shift the whole spline
+		for (FInterpCurvePoint<FVector>& ledgePoint : LedgeSpline.Points)
+		{
+			ledgePoint.InVal += stepLength;
+		}
+		LedgeSpline.Points.Insert(FInterpCurvePoint<FVector>(0.f, nextPoint), 0);
+		LedgeLength += stepLength;
+		LedgeDistance += stepLength;
+	}
+	LedgeSpline.AutoSetTangents();
+
+	return true;
+}
+
+FVector UCLSMovementComponent::GetLedgeNormal(float Distance) const
+{
+	const FVector ledgeTangent {LedgeSpline.EvalDerivative(Distance).GetSafeNormal()};
+	const FVector ledgeNormal {FVector::CrossProduct(ledgeTangent, FVector::UpVector).GetSafeNormal()};
+
+	if (ledgeNormal.IsNearlyZero())
+	{
+		return LedgeGrabNormal;
+	}
+
+	return FVector::DotProduct(ledgeNormal, LedgeGrabNormal) >= 0.f ? ledgeNormal : -ledgeNormal;
+}
+
+void UCLSMovementComponent::PhysLedgeHang(float DeltaTime)
+{
+	//vertical input leaves the ledge: up - top out, down - back to climbing
+	const float verticalInput {GetMaxAcceleration() > 0.f ? (float)(Acceleration.Z / GetMaxAcceleration()) : 0.f};
+	if (verticalInput > 0.5f)
+	{
+		//top out onto the ledge where we shimmied to, not where we grabbed it
+		LastLedgeTopLocation = LedgeSpline.Eval(LedgeDistance) - GetLedgeNormal(LedgeDistance) * CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius();
+		LastLedgeTopFrame = GFrameCounter;
+		DispatchClimbEvent(EClimbEvent::LedgeReached);
+		return;
+	}
+	if (verticalInput < -0.5f)
+	{
+		DispatchClimbEvent(EClimbEvent::LedgeReleased);
+		return;
+	}
+
+	const FVector ledgeTangent {LedgeSpline.EvalDerivative(LedgeDistance).GetSafeNormal()};
+
+	CalcVelocity(DeltaTime, ClimbingFriction, true, MaxBreakClimbDeceleration);
+	const float shimmySpeed {FMath::Clamp((float)FVector::DotProduct(Velocity, ledgeTangent), -MaxShimmySpeed, MaxShimmySpeed)};
+
+	float newLedgeDistance {LedgeDistance + shimmySpeed * DeltaTime};
+
+	//the only query while hanging: validate ledge past the spline end when we get there
+	if (newLedgeDistance > LedgeLength && !ExtendLedgeSpline(true))
+	{
+		newLedgeDistance = LedgeLength;
+	}
+	else if (newLedgeDistance < 0.f && !ExtendLedgeSpline(false))
+	{
+		newLedgeDistance = 0.f;
+	}
+	else if (newLedgeDistance < 0.f)
+	{
+		//spline was shifted forward by one step
+		newLedgeDistance = LedgeDistance + shimmySpeed * DeltaTime;
+	}
+
+	LedgeDistance = FMath::Clamp(newLedgeDistance, 0.f, LedgeLength);
+
+	const FVector edgePoint {LedgeSpline.Eval(LedgeDistance)};
+	const FVector ledgeNormal {GetLedgeNormal(LedgeDistance)};
+	const FVector targetLocation {edgePoint + ledgeNormal * LedgeHangOffset.X - FVector::UpVector * LedgeHangOffset.Y};
+
+	const FVector oldLocation {UpdatedComponent->GetComponentLocation()};
+	const FQuat targetRotation {FRotationMatrix::MakeFromX(-ledgeNormal).ToQuat()};
+	MoveUpdatedComponent(targetLocation - oldLocation, FMath::QInterpTo(UpdatedComponent->GetComponentQuat(), targetRotation, DeltaTime, 5.f), false);
+
+	Velocity = (UpdatedComponent->GetComponentLocation() - oldLocation) / DeltaTime;
+
+	//climb input and camera keep working with the ledge as climb surface
+	CurrentClimableSurfLocation = edgePoint;
+	CurrentClimableSurfNormal = ledgeNormal;
+}
+
+#pragma endregion
+
+#pragma region FallCatch
+
+void UCLSMovementComponent::PhysFalling(float deltaTime, int32 Iterations)
+{
+	Super::PhysFalling(deltaTime, Iterations);
+
+	if (MovementMode == MOVE_Falling)
+	{
+		TryCatchClimbWhileFalling();
+	}
+}
+
+bool UCLSMovementComponent::IsClimbSurfaceAlongFallPath() const
+{
+	/*
+		Vertical slab in front of the capsule covering where the body will be in the next few frames.
+		Its bottom is a step above the lower of current and predicted feet, so the floor the character lands on never overlaps it
+	*/
+	const FVector location {UpdatedComponent->GetComponentLocation()};
+	const FVector forward {UpdatedComponent->GetForwardVector()};
+	const FVector fallDelta {Velocity * FallCatchLookAheadTime};
+	const float capsuleRadius {CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleRadius()};
+	const float capsuleHalfHeight {CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight()};
+
+	const float slabBottom {(float)(location.Z - capsuleHalfHeight + FMath::Min(0.f, fallDelta.Z) + MaxStepHeight)};
+	const float slabTop {(float)(location.Z + capsuleHalfHeight + FMath::Max(0.f, fallDelta.Z))};
+	if (slabTop <= slabBottom)
+	{
+		return false;
+	}
+
+	const FVector horizontalFallDelta {FVector::VectorPlaneProject(fallDelta, FVector::UpVector)};
+	const float slabDepth {30.f + (float)FMath::Abs(FVector::DotProduct(horizontalFallDelta, forward))};
+	const float slabWidth {capsuleRadius + (float)FVector::VectorPlaneProject(horizontalFallDelta, forward).Size()};
+
+	FVector slabCenter {location + horizontalFallDelta * 0.5f + forward * (capsuleRadius + slabDepth * 0.5f)};
+	slabCenter.Z = (slabBottom + slabTop) * 0.5f;
+	const FVector slabExtent {slabDepth * 0.5f, slabWidth, (slabTop - slabBottom) * 0.5f};
+
+	FCollisionQueryParams queryParams {SCENE_QUERY_STAT(ClimbFallCatch), false, CharacterOwner};
+	return ClimbOverlapAny(slabCenter, UpdatedComponent->GetComponentQuat(), FCollisionShape::MakeBox(slabExtent), queryParams);
+}
+
+bool UCLSMovementComponent::ConsumeFallCatchBudget()
+{
+	static uint64 budgetFrame {0};
+	static int32 usedBudget {0};
+
+	if (budgetFrame != GFrameCounter)
+	{
+		budgetFrame = GFrameCounter;
+		usedBudget = 0;
+	}
+
+	if (usedBudget >= CVarFallCatchBudget.GetValueOnGameThread())
+	{
+		return false;
+	}
+
+	++usedBudget;
+	return true;
+}
+
+void UCLSMovementComponent::TryCatchClimbWhileFalling()
+{
+	if (!bCatchClimbWhileFalling || (ClimbState != EClimbState::Idle && ClimbState != EClimbState::Exiting) || IsPlayingClimbTransition())
+	{
+		return;
+	}
+
+	if (GetWorld()->GetTimeSeconds() - LastClimbExitTime < FallCatchCooldown)
+	{
+		return;
+	}
+
+	//player let go on purpose, grab the wall again only while pushing towards it
+	if (ClimbState == EClimbState::Exiting && bClimbReleasedByPlayer
+		&& FVector::DotProduct(Acceleration.GetSafeNormal2D(), UpdatedComponent->GetForwardVector()) < FallCatchReleasedInputThreshold)
+	{
+		return;
+	}
+
+	if (!IsClimbSurfaceAlongFallPath() || !ConsumeFallCatchBudget())
+	{
+		return;
+	}
+
+	//same probes as climb start on the ground
+	if (!TraceClimbSurfaces() || !TraceFromEyes(100).bBlockingHit)
+	{
+		return;
+	}
+
+	//slopes and floor edges are not walls
+	const float walkableFloorZ {GetWalkableFloorZ()};
+	if (!ClimbContacts.ContainsByPredicate([walkableFloorZ](const FClimbContact& Contact) {return Contact.Normal.Z < walkableFloorZ;}))
+	{
+		return;
+	}
+
+	GetClimbSurfaceInfo();
+
+	//wall ends right above the hands, catch its ledge instead of the wall
+	const bool bLedgeAbove {bHangOnLedgeReached && TraceLedgeTop()};
+
+	if (DispatchClimbEvent(EClimbEvent::FallCaught) && bLedgeAbove)
+	{
+		TryGrabLedge();
+	}
+}
+
+#pragma endregion
+
+#pragma region HandholdClimb
+
+UCLSHandholdComponent* UCLSMovementComponent::FindStartHandhold() const
+{
+	const UCLSHandholdSubsystem* handholdSubsystem {GetWorld()->GetSubsystem<UCLSHandholdSubsystem>()};
+	if (handholdSubsystem == nullptr || handholdSubsystem->GetNumHandholds() == 0 || IsFalling())
+	{
+		return nullptr;
+	}
+
+	const FVector forward {UpdatedComponent->GetForwardVector()};
+	return handholdSubsystem->FindBestHandhold(UpdatedComponent->GetComponentLocation(), forward, -forward, HandholdReach);
+}
+
+void UCLSMovementComponent::PhysHandholdClimb(float DeltaTime)
+{
+	/*
+		Character is attached to the current hold and moves to the next one along a smoothed lerp.
+		Next hold is picked from the subsystem index by input direction, so there are no traces or sweeps
+	*/
+
+	UCLSHandholdComponent* currentHandhold {CurrentHandhold.Get()};
+	UCLSHandholdComponent* targetHandhold {TargetHandhold.Get()};
+
+	//holds we were on are gone, grab another one in reach or let go
+	if (currentHandhold == nullptr && targetHandhold == nullptr)
+	{
+		currentHandhold = FindStartHandhold();
+		CurrentHandhold = currentHandhold;
+		TargetHandhold.Reset();
+
+		if (currentHandhold == nullptr)
+		{
+			DispatchClimbEvent(EClimbEvent::StopClimb);
+			return;
+		}
+	}
+
+	if (targetHandhold == nullptr && !Acceleration.IsNearlyZero())
+	{
+		const UCLSHandholdSubsystem* handholdSubsystem {GetWorld()->GetSubsystem<UCLSHandholdSubsystem>()};
+		targetHandhold = handholdSubsystem ? handholdSubsystem->FindBestHandhold(currentHandhold->GetComponentLocation(), Acceleration, currentHandhold->GetHoldNormal(), HandholdReach, currentHandhold) : nullptr;
+		TargetHandhold = targetHandhold;
+		HandholdMoveAlpha = 0.f;
+	}
+
+	FVector targetLocation;
+	FVector holdNormal;
+	if (targetHandhold != nullptr)
+	{
+		HandholdMoveAlpha = FMath::Min(HandholdMoveAlpha + DeltaTime / HandholdMoveDuration, 1.f);
+		const float moveAlpha {FMath::SmoothStep(0.f, 1.f, HandholdMoveAlpha)};
+
+		//current hold may be gone while moving, continue from where we are
+		const FVector fromLocation {currentHandhold ? currentHandhold->GetHangLocation() : UpdatedComponent->GetComponentLocation()};
+		const FVector fromNormal {currentHandhold ? currentHandhold->GetHoldNormal() : targetHandhold->GetHoldNormal()};
+
+		targetLocation = FMath::Lerp(fromLocation, targetHandhold->GetHangLocation(), moveAlpha);
+		holdNormal = FMath::Lerp(fromNormal, targetHandhold->GetHoldNormal(), moveAlpha).GetSafeNormal();
+
+		if (HandholdMoveAlpha >= 1.f)
+		{
+			CurrentHandhold = targetHandhold;
+			TargetHandhold.Reset();
+		}
+	}
+	else
+	{
+		targetLocation = currentHandhold->GetHangLocation();
+		holdNormal = currentHandhold->GetHoldNormal();
+	}
+
+	const FVector oldLocation {UpdatedComponent->GetComponentLocation()};
+	const FQuat targetRotation {FRotationMatrix::MakeFromX(-holdNormal).ToQuat()};
+	MoveUpdatedComponent(targetLocation - oldLocation, FMath::QInterpTo(UpdatedComponent->GetComponentQuat(), targetRotation, DeltaTime, 5.f), false);
+
+	Velocity = (UpdatedComponent->GetComponentLocation() - oldLocation) / DeltaTime;
+
+	//input directions and camera use holds as climb surface
+	CurrentClimableSurfLocation = targetHandhold ? targetHandhold->GetComponentLocation() : currentHandhold->GetComponentLocation();
+	CurrentClimableSurfNormal = holdNormal;
+}
+
+#pragma endregion
+
+#pragma region ClimbLimbProbes
+
+bool UCLSMovementComponent::ShouldProbeClimbLimbs() const
+{
+	//hand targets of handhold climbing come from the hold index
+	if (!bEnableClimbLimbProbes || ClimbState != EClimbState::Climbing || IsClimbingHandholds() || CurrentClimableSurfNormal.IsNearlyZero())
+	{
+		return false;
+	}
+
+	if (!CharacterOwner->GetMesh()->WasRecentlyRendered())
+	{
+		return false;
+	}
+
+	//no local camera (dedicated server) means nobody sees the limbs
+	const APlayerController* localPlayerController {GetWorld()->GetFirstPlayerController()};
+	if (localPlayerController == nullptr || localPlayerController->PlayerCameraManager == nullptr)
+	{
+		return false;
+	}
+
+	const FVector cameraLocation {localPlayerController->PlayerCameraManager->GetCameraLocation()};
+	return FVector::DistSquared(cameraLocation, UpdatedComponent->GetComponentLocation()) <= FMath::Square(ClimbLimbProbeMaxDistance);
+}
+
+void UCLSMovementComponent::IssueClimbLimbProbes()
+{
+	/*
+		Probes are generated from already known climb surface instead of tracing for it:
+		every limb gets a short line through the surface plane at its offset from the character
+	*/
+
+	const FVector surfaceNormal {CurrentClimableSurfNormal};
+	const FVector surfaceUp {FVector::VectorPlaneProject(UpdatedComponent->GetUpVector(), surfaceNormal).GetSafeNormal()};
+	const FVector surfaceRight {FVector::VectorPlaneProject(UpdatedComponent->GetRightVector(), surfaceNormal).GetSafeNormal()};
+	const FVector surfaceOrigin {FVector::PointPlaneProject(UpdatedComponent->GetComponentLocation(), CurrentClimableSurfLocation, surfaceNormal)};
+
+	const FVector2D limbOffsets[(int32)EClimbLimb::Count]
+	{
+		{-ClimbHandProbeOffset.X, ClimbHandProbeOffset.Y},
+		ClimbHandProbeOffset,
+		{-ClimbFootProbeOffset.X, ClimbFootProbeOffset.Y},
+		ClimbFootProbeOffset
+	};
+
+	const FCollisionQueryParams queryParams {SCENE_QUERY_STAT(ClimbLimbProbe), false, CharacterOwner};
+
+	for (int32 limbIndex = 0; limbIndex < (int32)EClimbLimb::Count; ++limbIndex)
+	{
+		const FVector probeCenter {surfaceOrigin + surfaceRight * limbOffsets[limbIndex].X + surfaceUp * limbOffsets[limbIndex].Y};
+		const FVector probeStart {probeCenter + surfaceNormal * ClimbLimbProbeDepth};
+		const FVector probeEnd {probeCenter - surfaceNormal * ClimbLimbProbeDepth};
+
+		//all limbs go to the same async batch, user data tells which limb result belongs to
+		if (ClimbQueryFilter == EClimbQueryFilter::ClimbableChannel)
+		{
+			GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, probeStart, probeEnd, ECC_Climbable, queryParams, FCollisionResponseParams::DefaultResponseParam, &ClimbLimbProbeDelegate, (uint32)limbIndex);
+		}
+		else
+		{
+			GetWorld()->AsyncLineTraceByObjectType(EAsyncTraceType::Single, probeStart, probeEnd, FCollisionObjectQueryParams(ClimbSurfaceTypes), queryParams, &ClimbLimbProbeDelegate, (uint32)limbIndex);
+		}
+	}
+
+	CountClimbQueries((int32)EClimbLimb::Count);
+}
+
+void UCLSMovementComponent::OnClimbLimbProbeCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
+{
+	if (TraceDatum.UserData >= (uint32)EClimbLimb::Count)
+	{
+		return;
+	}
+
+	FClimbLimbTarget& limbTarget {ClimbLimbTargets[TraceDatum.UserData]};
+
+	//probes that were issued before we stopped climbing are not valid anymore
+	const FHitResult* probeHit {TraceDatum.OutHits.Num() > 0 ? &TraceDatum.OutHits[0] : nullptr};
+
+#if CLS_WITH_TRACE_RECORDER
+	TraceRecorder.RecordLineTrace(EClimbQueryType::AsyncLineTrace, TraceDatum.Start, TraceDatum.End, probeHit ? *probeHit : FHitResult {});
+#endif
+	limbTarget.bValid = ClimbState == EClimbState::Climbing && probeHit != nullptr && probeHit->bBlockingHit;
+
+	if (limbTarget.bValid)
+	{
+		limbTarget.Location = probeHit->ImpactPoint;
+		limbTarget.Normal = probeHit->ImpactNormal;
+	}
+}
+
+void UCLSMovementComponent::ResetClimbLimbTargets()
+{
+	for (FClimbLimbTarget& limbTarget : ClimbLimbTargets)
+	{
+		limbTarget.bValid = false;
+	}
+}
+
+#pragma endregion
+
+#pragma region CapsuleMorph
+
+void UCLSMovementComponent::BeginCapsuleMorph(float TargetHalfHeight, const TOptional<FQuat>& TargetRotation /*= {}*/)
+{
+	CapsuleMorph.StartHalfHeight = CharacterOwner->GetCapsuleComponent()->GetUnscaledCapsuleHalfHeight();
+	CapsuleMorph.TargetHalfHeight = TargetHalfHeight;
+	CapsuleMorph.StartRotation = UpdatedComponent->GetComponentQuat();
+	CapsuleMorph.TargetRotation = TargetRotation.Get(CapsuleMorph.StartRotation);
+	CapsuleMorph.bMorphRotation = TargetRotation.IsSet();
+	CapsuleMorph.Elapsed = 0.f;
+	CapsuleMorph.bActive = true;
+
+	if (CapsuleMorphDuration <= 0.f)
+	{
+		TickCapsuleMorph(0.f);
+	}
+}
+
+void UCLSMovementComponent::TickCapsuleMorph(float DeltaTime)
+{
+	if (!CapsuleMorph.bActive)
+	{
+		return;
+	}
+
+	CapsuleMorph.Elapsed += DeltaTime;
+	const float alpha {CapsuleMorphDuration > 0.f ? FMath::Clamp(CapsuleMorph.Elapsed / CapsuleMorphDuration, 0.f, 1.f) : 1.f};
+
+	ApplyCapsuleMorphStep(alpha);
+
+	if (alpha >= 1.f)
+	{
+		CapsuleMorph.bActive = false;
+
+		//overlaps were not updated while capsule was resized
+		CharacterOwner->GetCapsuleComponent()->UpdateOverlaps();
+	}
+}
+
+void UCLSMovementComponent::ApplyCapsuleMorphStep(float Alpha)
+{
+	UCapsuleComponent* capsule {CharacterOwner->GetCapsuleComponent()};
+
+	const float newHalfHeight {FMath::Lerp(CapsuleMorph.StartHalfHeight, CapsuleMorph.TargetHalfHeight, Alpha)};
+	const FQuat newRotation {CapsuleMorph.bMorphRotation ? FQuat::Slerp(CapsuleMorph.StartRotation, CapsuleMorph.TargetRotation, Alpha) : UpdatedComponent->GetComponentQuat()};
+
+	capsule->SetCapsuleHalfHeight(newHalfHeight, false);
+
+	//zero length sweep of the resized capsule reports penetration, rotation correction is applied in the same move
+	const FVector location {UpdatedComponent->GetComponentLocation()};
+	FCollisionQueryParams queryParams {SCENE_QUERY_STAT(ClimbCapsuleMorph), false, CharacterOwner};
+	FCollisionResponseParams responseParams;
+	InitCollisionParams(queryParams, responseParams);
+
+	FHitResult hit;
+	const bool bBlocked {GetWorld()->SweepSingleByChannel(hit, location, location, newRotation, UpdatedComponent->GetCollisionObjectType(), capsule->GetCollisionShape(), queryParams, responseParams)};
+
+	if (bBlocked && hit.bStartPenetrating)
+	{
+		ResolvePenetration(GetPenetrationAdjustment(hit), hit, newRotation);
+	}
+	else if (CapsuleMorph.bMorphRotation)
+	{
+		MoveUpdatedComponent(FVector::ZeroVector, newRotation, false);
+	}
+}
+
+#pragma endregion
+
+#pragma region ClimbStateMachine
+
+namespace ClimbStateMachine
+{
+	constexpr int32 NumStates {(int32)EClimbState::Count};
+	constexpr int32 NumEvents {(int32)EClimbEvent::Count};
+
+	constexpr EClimbState Idle {EClimbState::Idle};
+	constexpr EClimbState Entering {EClimbState::Entering};
+	constexpr EClimbState Climbing {EClimbState::Climbing};
+	constexpr EClimbState ToppingOut {EClimbState::ToppingOut};
+	constexpr EClimbState Vaulting {EClimbState::Vaulting};
+	constexpr EClimbState Descending {EClimbState::Descending};
+	constexpr EClimbState Exiting {EClimbState::Exiting};
+	constexpr EClimbState Hanging {EClimbState::Hanging};
+
+	//no transition, event is suppressed
+	constexpr EClimbState X {EClimbState::Count};
+
+	constexpr EClimbState TransitionTable[NumStates][NumEvents]
+	{
+		//				StartClimb	StartDescend	StartVault	TransitionFinished	LedgeReached	StopClimb	Landed	LedgeGrabbed	LedgeReleased	FallCaught
+		/*Idle*/		{Entering,	Descending,		Vaulting,	X,					X,				X,			X,		X,				X,				Climbing},
+		/*Entering*/	{X,			X,				X,			Climbing,			X,				X,			X,		X,				X,				X},
+		/*Climbing*/	{X,			X,				X,			X,					ToppingOut,		Exiting,	X,		Hanging,		X,				X},
+		/*ToppingOut*/	{X,			X,				X,			Idle,				X,				X,			Idle,	X,				X,				X},
+		/*Vaulting*/	{X,			X,				X,			Idle,				X,				X,			X,		X,				X,				X},
+		/*Descending*/	{X,			X,				X,			Climbing,			X,				X,			X,		X,				X,				X},
+		/*Exiting*/		{X,			X,				X,			X,					X,				X,			Idle,	X,				X,				Climbing},
+		/*Hanging*/		{X,			X,				X,			X,					ToppingOut,		Exiting,	X,		X,				Climbing,		X},
+	};
+
+	static_assert(UE_ARRAY_COUNT(TransitionTable) == NumStates, "Every climb state needs a row in the transition table");
+
+	constexpr EClimbState GetNextState(EClimbState State, EClimbEvent Event)
+	{
+		return TransitionTable[(int32)State][(int32)Event];
+	}
+}
+
+bool UCLSMovementComponent::DispatchClimbEvent(EClimbEvent Event)
+{
+	const EClimbState previousState {ClimbState};
+	const EClimbState nextState {ClimbStateMachine::GetNextState(previousState, Event)};
+
+	if (nextState == ClimbStateMachine::X)
+	{
+		++SuppressedClimbEvents[(int32)Event];
+		UE_LOG(LogClimbingSystem, Verbose, TEXT("%s: climb event %s suppressed in state %s"), *GetNameSafe(GetOwner()), *UEnum::GetValueAsString(Event), *UEnum::GetValueAsString(previousState));
+		return false;
+	}
+
+	CSV_CUSTOM_STAT(Climbing, Transitions, 1, ECsvCustomStatOp::Accumulate);
+
+#if CLS_WITH_CLIMB_TELEMETRY
+	FClimbSessionTelemetry::Get().AddStateDuration(previousState, GetWorld()->GetTimeSeconds() - ClimbStateEnterTime);
+	FClimbSessionTelemetry::Get().AddTransition(previousState, nextState);
+#endif
+
+	ClimbState = nextState;
+	ClimbStateEnterTime = GetWorld()->GetTimeSeconds();
+	OnClimbStateEntered(nextState, previousState);
+
+	return true;
+}
+
+void UCLSMovementComponent::OnClimbStateEntered(EClimbState NewState, EClimbState PreviousState)
+{
+	switch (NewState)
+	{
+	case EClimbState::Idle:
+		//transitions that end on the ground
+		if (PreviousState == EClimbState::ToppingOut || PreviousState == EClimbState::Vaulting)
+		{
+			SetMovementMode(MOVE_Walking);
+		}
+		CurrentHandhold.Reset();
+		TargetHandhold.Reset();
+		bClimbReleasedByPlayer = false;
+		break;
+
+	case EClimbState::Entering:
+		PlayClimbMontage(SelectClimbTransition(EClimbState::Entering, IdleToClimb));
+		break;
+
+	case EClimbState::Descending:
+		PlayClimbMontage(SelectClimbTransition(EClimbState::Descending, IdleToLedge));
+		break;
+
+	case EClimbState::Climbing:
+		bClimbReleasedByPlayer = false;
+		StartClimbing();
+		break;
+
+	case EClimbState::Hanging:
+		//ledge is already extracted, character stays in climb mode
+		StopMovementImmediately();
+		break;
+
+	case EClimbState::ToppingOut:
+		EndClimbing();
+		PlayClimbMontage(SelectClimbTransition(EClimbState::ToppingOut, ClimbToLedge));
+		break;
+
+	case EClimbState::Vaulting:
+		StartClimbing();
+		PlayClimbMontage(SelectClimbTransition(EClimbState::Vaulting, Vault));
+		break;
+
+	case EClimbState::Exiting:
+		EndClimbing();
+		break;
+
+	default:
+		break;
+	}
+}
+
+#pragma endregion
+
+#pragma region ClimbAnimations
+
+TArray<FSoftObjectPath> UCLSMovementComponent::GetClimbAnimationPaths() const
+{
+	TArray<FSoftObjectPath> animationPaths;
+
+	for (const TSoftObjectPtr<UAnimMontage>* montage : {&IdleToClimb, &ClimbToLedge, &IdleToLedge, &Vault})
+	{
+		if (!montage->IsNull())
+		{
+			animationPaths.Add(montage->ToSoftObjectPath());
+		}
+	}
+
+	if (ClimbTransitionDatabase != nullptr)
+	{
+		for (const FSoftObjectPath& montagePath : ClimbTransitionDatabase->GetMontagePaths())
+		{
+			animationPaths.AddUnique(montagePath);
+		}
 	}
+
+	return animationPaths;
+}
+
+UAnimMontage* UCLSMovementComponent::GetClimbMontage(const TSoftObjectPtr<UAnimMontage>& Montage)
+{
+	if (UAnimMontage* loadedMontage = Montage.Get())
+	{
+		return loadedMontage;
+	}
+
+	if (Montage.IsNull())
+	{
+		return nullptr;
+	}
+
+	//streaming didn't finish in time, we can't skip transition animation
+	UE_LOG(LogClimbingSystem, Warning, TEXT("%s: climb montage %s was not streamed in, loading synchronously"), *GetNameSafe(GetOwner()), *Montage.ToString());
+
+	UAnimMontage* loadedMontage {Montage.LoadSynchronous()};
+
+	//keep the rest of animations referenced by streaming handle
+	PreloadClimbAnimations();
+
+	return loadedMontage;
+}
+
+void UCLSMovementComponent::UpdateClimbAnimationsPreload(float DeltaTime)
+{
+	if (ClimbAnimationsHandle.IsValid())
+	{
+		return;
+	}
+
+	TimeSinceClimbAnimationsPreloadCheck += DeltaTime;
+	if (TimeSinceClimbAnimationsPreloadCheck < ClimbAnimationsPreloadCheckInterval)
+	{
+		return;
+	}
+	TimeSinceClimbAnimationsPreloadCheck = 0.f;
+
+	const FVector location {UpdatedComponent->GetComponentLocation()};
+
+	//baked climb data answers without touching physics
+	const UCLSClimbDataSubsystem* climbDataSubsystem {GetWorld()->GetSubsystem<UCLSClimbDataSubsystem>()};
+	TArray<FClimbContact> nearbyContacts;
+	if (climbDataSubsystem && climbDataSubsystem->HasClimbData() && climbDataSubsystem->FindClimbContacts(location, ClimbAnimationsPreloadRadius, ClimbAnimationsPreloadRadius, nearbyContacts))
+	{
+		PreloadClimbAnimations();
+		return;
+	}
+
+	/*
+		Physics fallback goes through the configured climb filter. Slab starts above step height,
+		so floor and landscape around the character don't overlap it, and the floor we stand on is skipped for slopes
+	*/
+	const float feetHeight {(float)location.Z - CharacterOwner->GetCapsuleComponent()->GetScaledCapsuleHalfHeight()};
+	const float slabBottom {feetHeight + MaxStepHeight + 1.f};
+	const float slabTop {(float)location.Z + ClimbAnimationsPreloadRadius};
+	if (slabTop <= slabBottom)
+	{
+		return;
+	}
+
+	const FVector slabCenter {location.X, location.Y, (slabBottom + slabTop) * 0.5f};
+	const FVector slabExtent {ClimbAnimationsPreloadRadius, ClimbAnimationsPreloadRadius, (slabTop - slabBottom) * 0.5f};
+	const FCollisionQueryParams queryParams {SCENE_QUERY_STAT(ClimbAnimationsPreload), false, CharacterOwner};
+
+	CountClimbQueries(1);
+	TArray<FOverlapResult> overlaps;
+	ClimbOverlapMulti(overlaps, slabCenter, FQuat::Identity, FCollisionShape::MakeBox(slabExtent), queryParams);
+
+	const UPrimitiveComponent* floorComponent {CurrentFloor.IsWalkableFloor() ? CurrentFloor.HitResult.GetComponent() : nullptr};
+	const bool bNearClimbable {overlaps.ContainsByPredicate([floorComponent](const FOverlapResult& Overlap) {return Overlap.GetComponent() != floorComponent;})};
+
+#if CLS_WITH_TRACE_RECORDER
+	TraceRecorder.RecordOverlap(EClimbQueryType::OverlapTest, slabCenter, FCollisionShape::MakeBox(slabExtent), overlaps.Num());
+#endif
+
+	if (bNearClimbable)
+	{
+		PreloadClimbAnimations();
+	}
+}
+
+void UCLSMovementComponent::PreloadClimbAnimations()
+{
+	if (ClimbAnimationsHandle.IsValid())
+	{
+		return;
+	}
+
+	const TArray<FSoftObjectPath> animationPaths {GetClimbAnimationPaths()};
+	if (animationPaths.IsEmpty())
+	{
+		return;
+	}
+
+	ClimbAnimationsHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(animationPaths,
+		FStreamableDelegate::CreateUObject(this, &ThisClass::OnClimbAnimationsLoaded), FStreamableManager::AsyncLoadHighPriority);
+}
+
+void UCLSMovementComponent::ReleaseClimbAnimations()
+{
+	if (ClimbAnimationsHandle.IsValid())
+	{
+		ClimbAnimationsHandle->ReleaseHandle();
+		ClimbAnimationsHandle.Reset();
+	}
+}
+
+bool UCLSMovementComponent::AreClimbAnimationsLoaded() const
+{
+	return ClimbAnimationsHandle.IsValid() && ClimbAnimationsHandle->HasLoadCompleted();
+}
+
+SIZE_T UCLSMovementComponent::GetClimbAnimationsMemorySize() const
+{
+	SIZE_T animationsSize {0};
+
+	for (const FSoftObjectPath& montagePath : GetClimbAnimationPaths())
+	{
+		if (UAnimMontage* loadedMontage = Cast<UAnimMontage>(montagePath.ResolveObject()))
+		{
+			animationsSize += loadedMontage->GetResourceSizeBytes(EResourceSizeMode::EstimatedTotal);
+		}
+	}
+
+	return animationsSize;
+}
+
+void UCLSMovementComponent::OnClimbAnimationsLoaded()
+{
+	UE_LOG(LogClimbingSystem, Verbose, TEXT("%s: climb animations loaded, %.1f KB"), *GetNameSafe(GetOwner()), GetClimbAnimationsMemorySize() / 1024.f);
+
+	//extract root motion now so transitions don't pay for it
+	if (ShouldUseClimbTransitionTracks())
+	{
+		for (const FSoftObjectPath& montagePath : GetClimbAnimationPaths())
+		{
+			GetClimbTransitionTrack(Cast<UAnimMontage>(montagePath.ResolveObject()));
+		}
+	}
+}
+
+bool UCLSMovementComponent::ShouldUseClimbTransitionTracks() const
+{
+	switch (ClimbTransitionPlayback)
+	{
+	case EClimbTransitionPlayback::RootMotionTrack:
+		return true;
+	case EClimbTransitionPlayback::Auto:
+		return IsNetMode(NM_DedicatedServer);
+	default:
+		return false;
+	}
+}
+
+TSharedPtr<const FClimbTransitionTrack> UCLSMovementComponent::GetClimbTransitionTrack(UAnimMontage* Montage)
+{
+	if (Montage == nullptr)
+	{
+		return nullptr;
+	}
+
+	return FClimbTransitionTrack::FindOrExtract(*Montage, CharacterOwner->GetBaseRotationOffset(), ClimbTransitionTrackSampleRate);
+}
+
+void UCLSMovementComponent::PlayClimbTransitionTrack(UAnimMontage* Montage)
+{
+	TSharedPtr<const FClimbTransitionTrack> track {GetClimbTransitionTrack(Montage)};
+	check(track.IsValid());
+
+	TSharedPtr<FRootMotionSource_ClimbTransition> transitionSource {MakeShared<FRootMotionSource_ClimbTransition>()};
+	transitionSource->InstanceName = Montage->GetFName();
+	transitionSource->Priority = 500;
+	transitionSource->Duration = track->PlayLength;
+	transitionSource->SetTrack(*Montage, CharacterOwner->GetBaseRotationOffset(), ClimbTransitionTrackSampleRate);
+	transitionSource->StartRotation = UpdatedComponent->GetComponentQuat();
+
+	//stretch the track so it ends at warp target, like motion warping does for montage
+	if (ClimbTransitionWarpTarget.IsSet())
+	{
+		const FVector localTarget {transitionSource->StartRotation.UnrotateVector(ClimbTransitionWarpTarget.GetValue() - UpdatedComponent->GetComponentLocation())};
+		const FVector trackEnd {track->GetEndTranslation()};
+
+		for (int32 axis = 0; axis < 3; ++axis)
+		{
+			if (FMath::Abs(trackEnd[axis]) > 1.f)
+			{
+				transitionSource->TranslationScale[axis] = localTarget[axis] / trackEnd[axis];
+			}
+		}
+
+		ClimbTransitionWarpTarget.Reset();
+	}
+
+	ClimbTransitionRootMotionID = ApplyRootMotionSource(transitionSource);
+
+	//transition doesn't need animation, server doesn't have to tick the pose while it plays
+	USkeletalMeshComponent* mesh {CharacterOwner->GetMesh()};
+	if (bDisableServerMeshTick && IsNetMode(NM_DedicatedServer) && !bServerMeshTickDisabled)
+	{
+		MeshTickOptionBeforeTransition = mesh->VisibilityBasedAnimTickOption;
+		mesh->VisibilityBasedAnimTickOption = EVisibilityBasedAnimTickOption::OnlyTickPoseWhenRendered;
+		bServerMeshTickDisabled = true;
+	}
+
+	//end events fire when montage would start blending out
+	GetWorld()->GetTimerManager().SetTimer(ClimbTransitionEndTimer, FTimerDelegate::CreateUObject(this, &ThisClass::OnClimbTransitionTrackEnded, Montage), FMath::Max(track->BlendOutTime, UE_KINDA_SMALL_NUMBER), false);
+}
+
+void UCLSMovementComponent::OnClimbTransitionTrackEnded(UAnimMontage* Montage)
+{
+	if (bServerMeshTickDisabled)
+	{
+		CharacterOwner->GetMesh()->VisibilityBasedAnimTickOption = MeshTickOptionBeforeTransition;
+		bServerMeshTickDisabled = false;
+	}
+
+	OnClimbMontageEnded(Montage, false);
+}
+
+bool UCLSMovementComponent::IsPlayingClimbTransition() const
+{
+	if (ShouldUseClimbTransitionTracks())
+	{
+		if (ClimbTransitionRootMotionID == (uint16)ERootMotionSourceID::Invalid)
+		{
+			return false;
+		}
+
+		for (const TSharedPtr<FRootMotionSource>& rootMotionSource : CurrentRootMotion.RootMotionSources)
+		{
+			if (rootMotionSource.IsValid() && rootMotionSource->LocalID == ClimbTransitionRootMotionID)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	UAnimInstance* playerAnimInstance { GetCharacterOwner()->GetMesh()->GetAnimInstance() };
+	return playerAnimInstance->IsAnyMontagePlaying();
 }
 
 #pragma endregion
\ No newline at end of file
@@ -4,12 +4,19 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/CharacterMovementComponent.h"
+#include "Components/SkinnedMeshComponent.h"
+#include "CLSTraceRecorder.h"
 #include "CLSMovementComponent.generated.h"
 
 DECLARE_DELEGATE(FOnEnterClimbState)
 DECLARE_DELEGATE(FOnExitClimbState)
 
 class UAnimMontage;
+struct FStreamableHandle;
+struct FClimbTransitionTrack;
+class UCLSHandholdComponent;
+class UCLSClimbTransitionDatabase;
+class UCLSClimbDataSubsystem;
 
 UENUM(BlueprintType)
 enum class ECustomMovementMode : uint8
@@ -17,6 +24,151 @@ enum class ECustomMovementMode : uint8
 	MOVE_Climb UMETA(DisplayName = "Climb Node")
 };
 
+//High level climbing state. Changed only through climb events, see ClimbStateMachine::TransitionTable
+UENUM(BlueprintType)
+enum class EClimbState : uint8
+{
+	Idle,
+	Entering,
+	Climbing,
+	ToppingOut,
+	Vaulting,
+	Descending,
+	Exiting,
+	Hanging,
+
+	Count UMETA(Hidden)
+};
+
+UENUM(BlueprintType)
+enum class EClimbEvent : uint8
+{
+	StartClimb,
+	StartDescend,
+	StartVault,
+	//transition animation started blending out
+	TransitionFinished,
+	LedgeReached,
+	StopClimb,
+	//entered a movement mode that can't continue the climb: walking, swimming, flying
+	Landed,
+	LedgeGrabbed,
+	//dropped from ledge hang back to climbing
+	LedgeReleased,
+	//grabbed climb surface while falling
+	FallCaught,
+
+	Count UMETA(Hidden)
+};
+
+//How climb queries select primitives they can hit
+UENUM(BlueprintType)
+enum class EClimbQueryFilter : uint8
+{
+	//Query all primitives of ClimbSurfaceTypes object types
+	ObjectTypes UMETA(DisplayName = "Object Types"),
+
+	//Query only primitives that block Climbable trace channel
+	ClimbableChannel UMETA(DisplayName = "Climbable Channel")
+};
+
+//How climb transitions (montages) are played
+UENUM(BlueprintType)
+enum class EClimbTransitionPlayback : uint8
+{
+	//Play montages on the mesh
+	Montage UMETA(DisplayName = "Montage"),
+
+	//Play root motion pre-extracted from montages, animation is not evaluated
+	RootMotionTrack UMETA(DisplayName = "Root Motion Track"),
+
+	//Root motion tracks on dedicated server, montages everywhere else
+	Auto UMETA(DisplayName = "Auto")
+};
+
+//Contact point between climb query shape and a climbable primitive
+struct FClimbContact
+{
+	FVector Location {FVector::ZeroVector};
+
+	//points from the primitive towards the query shape
+	FVector Normal {FVector::ZeroVector};
+
+	float PenetrationDepth {0.f};
+
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+};
+
+UENUM(BlueprintType)
+enum class EClimbLimb : uint8
+{
+	HandLeft,
+	HandRight,
+	FootLeft,
+	FootRight,
+
+	Count UMETA(Hidden)
+};
+
+//What character can do from where it stands, see UCLSMovementComponent::EvaluateTraversalOptions
+struct FClimbTraversalOptions
+{
+	bool bCanClimb {false};
+	bool bCanDescend {false};
+	bool bCanVault {false};
+	FVector VaultStart {FVector::ZeroVector};
+	FVector VaultEnd {FVector::ZeroVector};
+};
+
+//Where limb touches the climb surface, result of async limb probe
+struct FClimbLimbTarget
+{
+	FVector Location {FVector::ZeroVector};
+	FVector Normal {FVector::ZeroVector};
+	bool bValid {false};
+};
+
+//Capsule half height (and optionally rotation) interpolated over several frames
+struct FClimbCapsuleMorph
+{
+	float StartHalfHeight {0.f};
+	float TargetHalfHeight {0.f};
+	FQuat StartRotation {FQuat::Identity};
+	FQuat TargetRotation {FQuat::Identity};
+	float Elapsed {0.f};
+	bool bMorphRotation {false};
+	bool bActive {false};
+};
+
+//Climb surface area server trusts client positions on without queries
+struct FClimbValidationPatch
+{
+	FVector Location {FVector::ZeroVector};
+	FVector Normal {FVector::ZeroVector};
+	bool bValid {false};
+
+	//primitive the patch lies on, keeps climb base tracking working
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+};
+
+//Turn around inner or outer corner along a horizontal arc, see UCLSMovementComponent::BeginCornerTurn
+struct FClimbCornerTurn
+{
+	FVector ArcCenter {FVector::ZeroVector};
+	FVector StartOffset {FVector::ZeroVector};
+
+	//from arc start to character location when the turn began, faded out along the arc
+	FVector StartGap {FVector::ZeroVector};
+	FVector TargetNormal {FVector::ZeroVector};
+	FVector TargetSurfaceLocation {FVector::ZeroVector};
+	FQuat StartRotation {FQuat::Identity};
+	FQuat TargetRotation {FQuat::Identity};
+	float Angle {0.f};
+	float ArcLength {0.f};
+	float Distance {0.f};
+	bool bActive {false};
+};
+
 /**
  * 
  */
@@ -31,6 +183,7 @@ public:
 	virtual float GetMaxSpeed() const override;
 	virtual float GetMaxAcceleration() const override;
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual FVector ConstrainAnimRootMotionVelocity(const FVector& RootMotionVelocity, const FVector& CurrentVelocity) const override;
 
 protected:
@@ -43,15 +196,30 @@ protected:
 	/** @note Movement update functions should only be called through StartNewPhysics()*/
 	virtual void PhysCustom(float deltaTime, int32 Iterations) override;
 
+	virtual void PhysFalling(float deltaTime, int32 Iterations) override;
+
+	virtual bool ServerCheckClientError(float ClientTimeStamp, float DeltaTime, const FVector& Accel, const FVector& ClientLoc, const FVector& RelativeClientLoc, UPrimitiveComponent* ClientMovementBase, FName ClientBaseBoneName, uint8 ClientMovementMode) override;
+
 #pragma endregion
 
 #pragma region ClimbTraces
 
 	private:
 
-	TArray <FHitResult> DoCapsuleTraceMultiByObject(const FVector& TraceStart, const FVector& TraceEnd, bool bShowDebug, bool bShowOneFrame);
+	//overlaps climb capsule with climbable primitives and computes contact point and normal for each of them, primitives baked into BakedClimbData are skipped
+	bool QueryClimbContacts(const FVector& QueryLocation, TArray<FClimbContact>& OutContacts, const UCLSClimbDataSubsystem* BakedClimbData = nullptr);
+
+	FHitResult DoClimbLineTraceSingle(const FVector& TraceStart, const FVector& TraceEnd);
 
-	FHitResult DoLineTraceSingleByObject(const FVector& TraceStart, const FVector& TraceEnd, bool bShowDebug, bool bShowOneFrame);
+#if CLS_WITH_TRACE_RECORDER
+	//latest climb queries, written from const query helpers too
+	mutable FClimbTraceRecorder TraceRecorder;
+#endif
+
+	//overlaps climbable primitives using ClimbQueryFilter
+	bool ClimbOverlapMulti(TArray<FOverlapResult>& OutOverlaps, const FVector& Location, const FQuat& Rotation, const FCollisionShape& Shape, const FCollisionQueryParams& Params) const;
+
+	bool ClimbOverlapAny(const FVector& Location, const FQuat& Rotation, const FCollisionShape& Shape, const FCollisionQueryParams& Params) const;
 
 #pragma endregion
 
@@ -60,6 +228,10 @@ protected:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
 	TArray<TEnumAsByte<EObjectTypeQuery> > ClimbSurfaceTypes;
 
+	//Climbable channel skips all geometry that didn't opt in (ClimbableSurface profile or SetComponentClimbable), Object Types is kept for compatibility
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	EClimbQueryFilter ClimbQueryFilter {EClimbQueryFilter::ObjectTypes};
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
 	float ClimbCapsuleTraceRadius {50.f};
 
@@ -77,39 +249,132 @@ protected:
 		
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
 	float MaxClimbSpeed {100.f};
+
+	//Gap kept between the capsule and the climbed wall, snap stops there so the move sweep doesn't hit the wall
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbWallGap {2.f};
+
+	//Max time the climb surface is reconstructed from the movement base before it is traced again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbSurfaceRevalidationInterval {0.2f};
+
+	//Distance character can move along the base since last trace before the climb surface is traced again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbSurfaceRevalidationDistance {25.f};
+
+	//Change of the movement base velocity since last trace that forces the climb surface to be traced again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbBaseVelocityChangeThreshold {150.f};
 	
 #pragma endregion
 
 #pragma region ClimbAnimations
 
+	//Climb animations are referenced softly and streamed in when character gets close to climbable geometry
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UAnimMontage> IdleToClimb;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	TSoftObjectPtr<UAnimMontage> ClimbToLedge;
+
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* IdleToClimb;
+	TSoftObjectPtr<UAnimMontage> IdleToLedge;
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* ClimbToLedge;
+	TSoftObjectPtr<UAnimMontage> Vault;
 
+	//Transition clips indexed by their root motion, the closest one to the transition target replaces the montages above
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* IdleToLedge;
+	TObjectPtr<UCLSClimbTransitionDatabase> ClimbTransitionDatabase;
+
+	//wall point below the ledge found by the last CanStartDescending
+	FVector LastDescendLedgeLocation {FVector::ZeroVector};
+
+	//where the character has to be at the end of the transition played in given state
+	TOptional<FVector> GetClimbTransitionTarget(EClimbState Transition) const;
+
+	//returns transition database clip closest to the transition target, or default montage when database has none
+	TSoftObjectPtr<UAnimMontage> SelectClimbTransition(EClimbState Transition, const TSoftObjectPtr<UAnimMontage>& DefaultMontage);
+
+	//Climb animations start streaming when baked climb data or climbable geometry above step height is closer than that
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbAnimationsPreloadRadius {600.f};
+
+	//How often we look for climbable geometry around character while climb animations are not loaded
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbAnimationsPreloadCheckInterval {0.5f};
+
+	TSharedPtr<FStreamableHandle> ClimbAnimationsHandle;
+	float TimeSinceClimbAnimationsPreloadCheck {0.f};
+
+	TArray<FSoftObjectPath> GetClimbAnimationPaths() const;
+
+	//returns loaded montage, loads it synchronously if streaming didn't finish yet
+	UAnimMontage* GetClimbMontage(const TSoftObjectPtr<UAnimMontage>& Montage);
+
+	//starts streaming climb animations when character is near climbable geometry
+	void UpdateClimbAnimationsPreload(float DeltaTime);
+
+	void OnClimbAnimationsLoaded();
 
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
-	UAnimMontage* Vault;
+	EClimbTransitionPlayback ClimbTransitionPlayback {EClimbTransitionPlayback::Auto};
+
+	//Samples per second of root motion extracted from transition montages
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "1", UIMin = "1"))
+	float ClimbTransitionTrackSampleRate {30.f};
+
+	//Stop ticking mesh pose on dedicated server while transition track is playing
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	bool bDisableServerMeshTick {true};
+
+	bool bServerMeshTickDisabled {false};
+	EVisibilityBasedAnimTickOption MeshTickOptionBeforeTransition {EVisibilityBasedAnimTickOption::AlwaysTickPose};
+
+	uint16 ClimbTransitionRootMotionID {0};
+	FTimerHandle ClimbTransitionEndTimer;
+
+	//where the character has to be at the end of next transition, played tracks are scaled to reach it
+	TOptional<FVector> ClimbTransitionWarpTarget;
+
+	bool ShouldUseClimbTransitionTracks() const;
+
+	//returns root motion track of the montage shared between characters, extracts it when montage is used first time
+	TSharedPtr<const FClimbTransitionTrack> GetClimbTransitionTrack(UAnimMontage* Montage);
+
+	void PlayClimbTransitionTrack(UAnimMontage* Montage);
+
+	void OnClimbTransitionTrackEnded(UAnimMontage* Montage);
+
+	//returns true while transition montage or its root motion track is playing
+	bool IsPlayingClimbTransition() const;
 
 #pragma endregion
 
 #pragma region ClimbCoreVariables
 
-	TArray <FHitResult> ClimbTraceResults;
+	TArray <FClimbContact> ClimbContacts;
 	FVector CurrentClimableSurfLocation;
 	FVector CurrentClimableSurfNormal;
 
+	//Primitive we are climbing on. Used as movement base, climb surface is cached in its local space
+	TWeakObjectPtr<UPrimitiveComponent> ClimbBase;
+	FName ClimbBaseBoneName;
+	FVector ClimbBaseLocalSurfLocation;
+	FVector ClimbBaseLocalSurfNormal;
+	FVector ClimbBaseLocalCharLocation;
+	FVector ClimbBaseVelocityAtValidation;
+	float TimeSinceClimbSurfaceValidation {0.f};
+
 #pragma endregion
 
 #pragma region ClimbCore
 
-	//returns true if traced is at least one valid climable surface while filling ClimbTraceResults array
-	bool TraceClimbSurfaces(bool bShowDebug = false, bool bShowOneFrame = true);
+	//returns true if traced is at least one valid climable surface while filling ClimbContacts array
+	bool TraceClimbSurfaces();
 
-	FHitResult TraceFromEyes(float TraceDistance, float TraceStartOffset = 0, bool bShowDebug = false, bool bShowOneFrame = true);
+	FHitResult TraceFromEyes(float TraceDistance, float TraceStartOffset = 0);
 
 	//returns true if in front of character there is a surface that we can climb UP 
 	bool CanStartClimbing();
@@ -128,34 +393,345 @@ protected:
 
 	void GetClimbSurfaceInfo();
 
+	//attaches character to the traced climb surface and caches surface info in its local space
+	void UpdateClimbBase();
+
+	//returns true if climb surface info was restored from the cached base-local contact, false if it has to be traced again
+	bool UpdateClimbSurfaceFromBase(float DeltaTime);
+
 	//checks if we should stop climbing by checking if climbing surface is horizontal
 	bool ShouldStopClimbing() const;
 
 	bool IsFloorReached();
 	bool IsLedgeReached();
 
+	//traces for ledge top just above the eyes, stores it in LastLedgeTopLocation
+	bool TraceLedgeTop();
+
 	//calculates rotation where forward vector corresponds to surface normal
 	FQuat GetClimbRotation(float DeltaTime) const;
 
-	//Moves component in direction of surface normal
-	void SnapToClimable(float DeltaTime);
+	//returns offset that moves component in direction of surface normal to snap it to the wall
+	FVector GetClimbSnapOffset(float DeltaTime) const;
+
+	//Moves component along the climb surface and snaps it to the wall with a single sweep
+	void MoveAlongClimbSurface(float DeltaTime);
 
-	void PlayClimbMontage (UAnimMontage* AnimToPlay);
+	void PlayClimbMontage (const TSoftObjectPtr<UAnimMontage>& AnimToPlay);
 
 	UFUNCTION()
 	void OnClimbMontageEnded(UAnimMontage* Montage, bool bInterrupted);
 
 #pragma endregion
 
+#pragma region ClimbMoveValidation
+
+	//Max lateral distance from validated contact where client climb positions are accepted without probing
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Validation", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbValidationPatchRadius {75.f};
+
+	//Max distance between client capsule center and climb surface
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Validation", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbValidationMaxWallDistance {100.f};
+
+	//Distance over MaxClimbSpeed * DeltaTime a client climb position may be from the server one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Validation", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbValidationMoveTolerance {10.f};
+
+	//surface contact last validated for the owning connection, lives on the server only
+	FClimbValidationPatch ClimbValidationPatch;
+
+	bool bAcceptClientPositionBeforeClimb {false};
+
+	//bServerAcceptClientAuthoritativePosition was changed on climb enter and has to be restored on exit
+	bool bAcceptClientPositionOverridden {false};
+
+	int32 NumAcceptedClimbMoves {0};
+	int32 NumClimbValidationProbes {0};
+	int32 NumRejectedClimbMoves {0};
+
+	//server simulating a remote client's climb with validation on
+	bool IsValidatingClimbMoves() const;
+
+	bool IsInsideClimbValidationPatch(const FVector& Location) const;
+
+	//one line probe from server location, refreshes patch on success
+	bool ProbeClimbValidationPatch();
+
+	//server uses validated patch as climb surface instead of tracing for it
+	bool UpdateClimbSurfaceFromValidationPatch();
+
+#pragma endregion
+
+#pragma region CornerTurn
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Corners", meta = (AllowPrivateAccess = "true"))
+	bool bEnableCornerTurns {true};
+
+	//How far beyond capsule edge side probes look for corners
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Corners", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float CornerProbeDistance {30.f};
+
+	//Min angle between walls that is handled as a corner
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Corners", meta = (AllowPrivateAccess = "true", ClampMin = "0", ClampMax = "180", UIMin = "0", UIMax = "180"))
+	float CornerMinAngle {30.f};
+
+	FClimbCornerTurn CornerTurn;
+
+	//probes capsule edge on the side we are moving to, starts corner turn if it finds another wall
+	bool TryStartCornerTurn();
+
+	//sets up the arc and checks its end pose with one sweep, false if the character wouldn't fit there
+	bool BeginCornerTurn(const FVector& NewWallNormal, const FVector& NewWallLocation, bool bOuterCorner);
+
+	//moves along precomputed arc, no sweeps
+	void PhysCornerTurn(float DeltaTime);
+
+#pragma endregion
+
+#pragma region CapsuleMorph
+
+	//Time it takes to resize capsule when entering or exiting climbing
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float CapsuleMorphDuration {0.1f};
+
+	FClimbCapsuleMorph CapsuleMorph;
+
+	void TickCapsuleMorph(float DeltaTime);
+
+	//resizes capsule and rotates component for the given morph progress, resolves penetration with a single sweep
+	void ApplyCapsuleMorphStep(float Alpha);
+
+#pragma endregion
+
+#pragma region LedgeHang
+
+	//Hang on reached ledges and shimmy along them instead of topping out right away
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Ledge", meta = (AllowPrivateAccess = "true"))
+	bool bHangOnLedgeReached {false};
+
+	//Distance between ledge probes when ledge is extracted
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Ledge", meta = (AllowPrivateAccess = "true", ClampMin = "1", UIMin = "1"))
+	float LedgeProbeStep {25.f};
+
+	//How far ledge is extracted to each side of the character on grab
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Ledge", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float LedgeExtractExtent {300.f};
+
+	//Max height difference between neighbouring ledge points
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Ledge", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float LedgeMaxStepHeight {15.f};
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Ledge", meta = (AllowPrivateAccess = "true"))
+	float MaxShimmySpeed {80.f};
+
+	//ledge edge, key is distance along the ledge
+	FInterpCurveVector LedgeSpline;
+	float LedgeLength {0.f};
+	float LedgeDistance {0.f};
+
+	//wall normal at the moment of grab, used to orient ledge normals
+	FVector LedgeGrabNormal;
+
+	//character offset from ledge edge: X - along ledge normal, Y - down
+	FVector2D LedgeHangOffset;
+
+	//top of the ledge found by the last IsLedgeReached or left hanging upwards
+	FVector LastLedgeTopLocation;
+	uint64 LastLedgeTopFrame {0};
+
+	//extracts ledge in front of the character and starts hanging on it
+	bool TryGrabLedge();
+
+	//probes ledge top at given point, returns edge point
+	bool ProbeLedgePoint(const FVector& AlongLedgePoint, const FVector& WallNormal, FVector& OutEdgePoint);
+
+	//fills LedgeSpline by probing along the edge in both directions
+	bool ExtractLedgeSpline(const FVector& EdgePoint, const FVector& WallNormal);
+
+	//probes one step past the spline end, extends spline if ledge continues
+	bool ExtendLedgeSpline(bool bAtEnd);
+
+	FVector GetLedgeNormal(float Distance) const;
+
+	void PhysLedgeHang(float DeltaTime);
+
+#pragma endregion
+
+#pragma region FallCatch
+
+	//Grab climbable surfaces automatically while falling, ledges are grabbed too when bHangOnLedgeReached is set
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Fall Catch", meta = (AllowPrivateAccess = "true"))
+	bool bCatchClimbWhileFalling {false};
+
+	//How far ahead along fall velocity the broad phase check looks
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Fall Catch", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float FallCatchLookAheadTime {0.15f};
+
+	//Time after leaving climb mode when falling character won't grab surfaces again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Fall Catch", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float FallCatchCooldown {0.5f};
+
+	//After the player lets go of the wall, input has to point at least that much towards it to grab it again
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Fall Catch", meta = (AllowPrivateAccess = "true", ClampMin = "-1", ClampMax = "1", UIMin = "-1", UIMax = "1"))
+	float FallCatchReleasedInputThreshold {0.5f};
+
+	float LastClimbExitTime {-UE_BIG_NUMBER};
+
+	//climb was stopped by player input, not by running out of wall
+	bool bClimbReleasedByPlayer {false};
+
+	//cheap overlap of the fall path in front of the capsule against climbable primitives, floor is kept out of it
+	bool IsClimbSurfaceAlongFallPath() const;
+
+	//takes one full check from per-frame budget shared by all characters
+	static bool ConsumeFallCatchBudget();
+
+	void TryCatchClimbWhileFalling();
+
+#pragma endregion
+
+#pragma region HandholdClimb
+
+	//Max distance from current hold to the next one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Handholds", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float HandholdReach {120.f};
+
+	//Time to move from one hold to another
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Handholds", meta = (AllowPrivateAccess = "true", ClampMin = "0.01", UIMin = "0.01"))
+	float HandholdMoveDuration {0.35f};
+
+	TWeakObjectPtr<UCLSHandholdComponent> CurrentHandhold;
+	TWeakObjectPtr<UCLSHandholdComponent> TargetHandhold;
+	float HandholdMoveAlpha {0.f};
+
+	//picks reachable hold in front of the character, used to start climbing
+	UCLSHandholdComponent* FindStartHandhold() const;
+
+	void PhysHandholdClimb(float DeltaTime);
+
+#pragma endregion
+
+#pragma region ClimbLimbProbes
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Limbs", meta = (AllowPrivateAccess = "true"))
+	bool bEnableClimbLimbProbes {true};
+
+	//Right hand probe position relative to the character on climb surface: X - right, Y - up. Left hand is mirrored
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Limbs", meta = (AllowPrivateAccess = "true"))
+	FVector2D ClimbHandProbeOffset {25.f, 60.f};
+
+	//Right foot probe position relative to the character on climb surface: X - right, Y - up. Left foot is mirrored
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Limbs", meta = (AllowPrivateAccess = "true"))
+	FVector2D ClimbFootProbeOffset {20.f, -70.f};
+
+	//Limb probes start and end this far in front of and behind climb surface
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Limbs", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbLimbProbeDepth {40.f};
+
+	//Limb probes are disabled for characters further than that from local camera
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, category = "Character Movement: Climbing|Limbs", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbLimbProbeMaxDistance {2500.f};
+
+	FClimbLimbTarget ClimbLimbTargets[(int32)EClimbLimb::Count];
+
+	FTraceDelegate ClimbLimbProbeDelegate;
+
+	//distance LOD, probes are not needed when limbs are not visible
+	bool ShouldProbeClimbLimbs() const;
+
+	//issues async probes for all limbs from the known climb surface, results arrive next frame
+	void IssueClimbLimbProbes();
+
+	void OnClimbLimbProbeCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	void ResetClimbLimbTargets();
+
+#pragma endregion
+
+#pragma region ClimbStateMachine
+
+	EClimbState ClimbState {EClimbState::Idle};
+
+	//world time when current climb state was entered
+	double ClimbStateEnterTime {0.0};
+
+	//events that had no transition from the state they arrived in
+	int32 SuppressedClimbEvents[(int32)EClimbEvent::Count] {};
+
+	//returns true if event caused a transition
+	bool DispatchClimbEvent(EClimbEvent Event);
+
+	//movement mode changes and animations of the state we just entered
+	void OnClimbStateEntered(EClimbState NewState, EClimbState PreviousState);
+
+#pragma endregion
+
 public:
 	void ToggleClimbing(bool bEnable);
 
+	//opts component in or out of climbing when climb queries use Climbable channel
+	UFUNCTION(BlueprintCallable, category = "Character Movement: Climbing")
+	static void SetComponentClimbable(UPrimitiveComponent* Component, bool bClimbable);
+
 	bool IsClimbing() const;
 
+	//interpolates capsule half height (and rotation if set) over CapsuleMorphDuration
+	void BeginCapsuleMorph(float TargetHalfHeight, const TOptional<FQuat>& TargetRotation = {});
+
+	FORCEINLINE EClimbState GetClimbState() const {return ClimbState;};
+
+	FORCEINLINE bool IsHangingOnLedge() const {return ClimbState == EClimbState::Hanging;};
+
+	FORCEINLINE bool IsClimbingHandholds() const {return CurrentHandhold.IsValid();};
+
+	FORCEINLINE float GetClimbCapsuleTraceRadius() const {return ClimbCapsuleTraceRadius;};
+
+	FORCEINLINE float GetClimbCapsuleTraceHalfHeight() const {return ClimbCapsuleTraceHalfHeight;};
+
+	//true if climb queries of this component can hit the primitive
+	bool CanClimbPrimitive(const UPrimitiveComponent* Primitive) const;
+
+	//false when object type filter has no types, so no primitive is climbable
+	FORCEINLINE bool HasClimbQueryFilter() const {return ClimbQueryFilter == EClimbQueryFilter::ClimbableChannel || !ClimbSurfaceTypes.IsEmpty();};
+
+	FORCEINLINE int32 GetNumAcceptedClimbMoves() const {return NumAcceptedClimbMoves;};
+	FORCEINLINE int32 GetNumClimbValidationProbes() const {return NumClimbValidationProbes;};
+	FORCEINLINE int32 GetNumRejectedClimbMoves() const {return NumRejectedClimbMoves;};
+
+#if CLS_WITH_TRACE_RECORDER
+	FORCEINLINE const FClimbTraceRecorder& GetTraceRecorder() const {return TraceRecorder;};
+#endif
+
+	FORCEINLINE int32 GetSuppressedClimbEventCount(EClimbEvent Event) const {return SuppressedClimbEvents[(int32)Event];};
+
 	FORCEINLINE FVector GetClimbSurfaceNormal () const {return CurrentClimableSurfNormal;};
 
+	FORCEINLINE FVector GetClimbSurfaceLocation () const {return CurrentClimableSurfLocation;};
+
+	FORCEINLINE const FClimbLimbTarget& GetClimbLimbTarget (EClimbLimb Limb) const {return ClimbLimbTargets[(int32)Limb];};
+
+	//starts streaming climb animations, e.g. when character enters traversal area
+	UFUNCTION(BlueprintCallable, category = "Character Movement: Climbing")
+	void PreloadClimbAnimations();
+
+	UFUNCTION(BlueprintCallable, category = "Character Movement: Climbing")
+	void ReleaseClimbAnimations();
+
+	UFUNCTION(BlueprintPure, category = "Character Movement: Climbing")
+	bool AreClimbAnimationsLoaded() const;
+
+	//returns estimated memory used by loaded climb animations
+	SIZE_T GetClimbAnimationsMemorySize() const;
+
 	FVector GetUnrotatedClimbVelocity() const;
 
+	/*
+		Runs the same detection as ToggleClimbing without starting anything.
+		Synchronous, AI should go through UCLSTraversalQuerySubsystem instead
+	*/
+	FClimbTraversalOptions EvaluateTraversalOptions();
+
 public:
 	FOnEnterClimbState OnEnterClimbStateDelegate;
 	FOnExitClimbState OnExitClimbStateDelegate;
@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CLSRootMotionSource.h"
+#include "Animation/AnimMontage.h"
+
+FVector FClimbTransitionTrack::Sample(float Time) const
+{
+	if (Translations.IsEmpty() || SampleInterval <= 0.f)
+	{
+		return FVector::ZeroVector;
+	}
+
+	const float samplePosition {FMath::Max(0.f, Time) / SampleInterval};
+	const int32 sampleIndex {FMath::Min(FMath::FloorToInt32(samplePosition), Translations.Num() - 1)};
+	const int32 nextSampleIndex {FMath::Min(sampleIndex + 1, Translations.Num() - 1)};
+
+	return FMath::Lerp(Translations[sampleIndex], Translations[nextSampleIndex], samplePosition - sampleIndex);
+}
+
+FVector FClimbTransitionTrack::GetEndTranslation() const
+{
+	return Translations.IsEmpty() ? FVector::ZeroVector : Translations.Last();
+}
+
+FClimbTransitionTrack FClimbTransitionTrack::Extract(const UAnimMontage& Montage, const FQuat& MeshToActorRotation, float SampleRate)
+{
+	FClimbTransitionTrack track;
+
+	const float rateScale {Montage.RateScale > 0.f ? Montage.RateScale : 1.f};
+	const float montageLength {Montage.GetPlayLength()};
+
+	track.PlayLength = montageLength / rateScale;
+	track.SampleInterval = 1.f / FMath::Max(SampleRate, 1.f);
+
+	//same rule montage instance uses to start blending out
+	const float blendOutTriggerTime {Montage.BlendOutTriggerTime >= 0.f ? Montage.BlendOutTriggerTime : Montage.BlendOut.GetBlendTime()};
+	track.BlendOutTime = FMath::Max(0.f, montageLength - blendOutTriggerTime) / rateScale;
+
+	const int32 numSamples {FMath::CeilToInt32(track.PlayLength / track.SampleInterval) + 1};
+	track.Translations.Reserve(numSamples);
+
+	for (int32 i = 0; i < numSamples; ++i)
+	{
+		const float trackPosition {FMath::Min(i * track.SampleInterval * rateScale, montageLength)};
+		const FTransform rootMotion {Montage.ExtractRootMotionFromTrackRange(0.f, trackPosition)};
+
+		//root motion is extracted in mesh space
+		track.Translations.Add(MeshToActorRotation.RotateVector(rootMotion.GetTranslation()));
+	}
+
+	return track;
+}
+
+TSharedPtr<const FClimbTransitionTrack> FClimbTransitionTrack::FindOrExtract(const UAnimMontage& Montage, const FQuat& MeshToActorRotation, float SampleRate)
+{
+	//tracks are only played on game thread, no need to guard the cache
+	check(IsInGameThread());
+
+	static TMap<FString, TSharedPtr<const FClimbTransitionTrack>> tracks;
+
+	const FString key {FString::Printf(TEXT("%s %s %f"), *Montage.GetPathName(), *MeshToActorRotation.ToString(), SampleRate)};
+
+	if (const TSharedPtr<const FClimbTransitionTrack>* track {tracks.Find(key)})
+	{
+		return *track;
+	}
+
+	return tracks.Add(key, MakeShared<const FClimbTransitionTrack>(Extract(Montage, MeshToActorRotation, SampleRate)));
+}
+
+FRootMotionSource_ClimbTransition::FRootMotionSource_ClimbTransition()
+{
+	AccumulateMode = ERootMotionAccumulateMode::Override;
+}
+
+void FRootMotionSource_ClimbTransition::SetTrack(const UAnimMontage& InMontage, const FQuat& InMeshToActorRotation, float InSampleRate)
+{
+	Montage = FSoftObjectPath(&InMontage);
+	MeshToActorRotation = InMeshToActorRotation;
+	SampleRate = InSampleRate;
+	Track = FClimbTransitionTrack::FindOrExtract(InMontage, InMeshToActorRotation, InSampleRate);
+}
+
+FRootMotionSource* FRootMotionSource_ClimbTransition::Clone() const
+{
+	FRootMotionSource_ClimbTransition* copyPtr {new FRootMotionSource_ClimbTransition(*this)};
+	return copyPtr;
+}
+
+bool FRootMotionSource_ClimbTransition::Matches(const FRootMotionSource* Other) const
+{
+	if (!FRootMotionSource::Matches(Other))
+	{
+		return false;
+	}
+
+	//We can cast safely here since in FRootMotionSource::Matches() we ensured ScriptStruct equality
+	const FRootMotionSource_ClimbTransition* otherCast {static_cast<const FRootMotionSource_ClimbTransition*>(Other)};
+
+	return Track == otherCast->Track && StartRotation.Equals(otherCast->StartRotation) && TranslationScale.Equals(otherCast->TranslationScale);
+}
+
+void FRootMotionSource_ClimbTransition::PrepareRootMotion(float SimulationTime, float MovementTickTime, const ACharacter& Character, const UCharacterMovementComponent& MoveComponent)
+{
+	RootMotionParams.Clear();
+
+	if (Track.IsValid() && MovementTickTime > UE_SMALL_NUMBER && SimulationTime > UE_SMALL_NUMBER)
+	{
+		const FVector currentTranslation {Track->Sample(GetTime())};
+		const FVector targetTranslation {Track->Sample(GetTime() + SimulationTime)};
+		const FVector worldDelta {StartRotation.RotateVector((targetTranslation - currentTranslation) * TranslationScale)};
+
+		const FTransform newTransform {worldDelta / MovementTickTime};
+		RootMotionParams.Set(newTransform);
+	}
+
+	SetTime(GetTime() + SimulationTime);
+}
+
+bool FRootMotionSource_ClimbTransition::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	if (!FRootMotionSource::NetSerialize(Ar, Map, bOutSuccess))
+	{
+		return false;
+	}
+
+	//track itself is not replicated, only the montage it comes from
+	Montage.NetSerialize(Ar, Map, bOutSuccess);
+	Ar << MeshToActorRotation;
+	Ar << SampleRate;
+	Ar << StartRotation;
+	Ar << TranslationScale;
+
+	if (Ar.IsLoading())
+	{
+		Track.Reset();
+
+		//montages are preloaded while climbing, load only if this one was missed
+		const UAnimMontage* montage {Cast<UAnimMontage>(Montage.ResolveObject())};
+		if (montage == nullptr)
+		{
+			montage = Cast<UAnimMontage>(Montage.TryLoad());
+		}
+
+		if (montage != nullptr)
+		{
+			Track = FClimbTransitionTrack::FindOrExtract(*montage, MeshToActorRotation, SampleRate);
+		}
+	}
+
+	bOutSuccess = true;
+	return true;
+}
+
+UScriptStruct* FRootMotionSource_ClimbTransition::GetScriptStruct() const
+{
+	return FRootMotionSource_ClimbTransition::StaticStruct();
+}
+
+FString FRootMotionSource_ClimbTransition::ToSimpleString() const
+{
+	return FString::Printf(TEXT("[ID:%u]FRootMotionSource_ClimbTransition %s"), LocalID, *InstanceName.GetPlainNameString());
+}
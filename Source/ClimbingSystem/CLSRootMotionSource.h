@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/RootMotionSource.h"
+#include "CLSRootMotionSource.generated.h"
+
+class UAnimMontage;
+
+//Root motion translation of a climb transition montage, pre-extracted so it can be played without evaluating animation
+struct CLIMBINGSYSTEM_API FClimbTransitionTrack
+{
+	//translation from the start of the montage at every sample, in actor local space
+	TArray<FVector> Translations;
+
+	float SampleInterval {0.f};
+
+	//time after which montage would be completely finished
+	float PlayLength {0.f};
+
+	//time when montage would start blending out and fire its end events
+	float BlendOutTime {0.f};
+
+	//returns translation from the start of the track at given time
+	FVector Sample(float Time) const;
+
+	FVector GetEndTranslation() const;
+
+	static FClimbTransitionTrack Extract(const UAnimMontage& Montage, const FQuat& MeshToActorRotation, float SampleRate);
+
+	//returns track shared by everyone playing the montage with the same settings, extracts it on first use
+	static TSharedPtr<const FClimbTransitionTrack> FindOrExtract(const UAnimMontage& Montage, const FQuat& MeshToActorRotation, float SampleRate);
+};
+
+/**
+ * Plays FClimbTransitionTrack as root motion. Used instead of transition montages where animation is not evaluated (dedicated server)
+ */
+USTRUCT()
+struct CLIMBINGSYSTEM_API FRootMotionSource_ClimbTransition : public FRootMotionSource
+{
+	GENERATED_USTRUCT_BODY()
+
+	FRootMotionSource_ClimbTransition();
+
+	virtual ~FRootMotionSource_ClimbTransition() {}
+
+	//track is shared between all sources playing the same montage, rebuilt from the fields below when received
+	TSharedPtr<const FClimbTransitionTrack> Track;
+
+	//montage the track was extracted from
+	UPROPERTY()
+	FSoftObjectPath Montage;
+
+	UPROPERTY()
+	FQuat MeshToActorRotation {FQuat::Identity};
+
+	UPROPERTY()
+	float SampleRate {30.f};
+
+	//actor rotation when the transition started
+	UPROPERTY()
+	FQuat StartRotation {FQuat::Identity};
+
+	//per axis scale of the track translation, used to reach warp targets
+	UPROPERTY()
+	FVector TranslationScale {FVector::OneVector};
+
+	//sets the track and what is needed to rebuild it on remote machines
+	void SetTrack(const UAnimMontage& InMontage, const FQuat& InMeshToActorRotation, float InSampleRate);
+
+	virtual FRootMotionSource* Clone() const override;
+
+	virtual bool Matches(const FRootMotionSource* Other) const override;
+
+	virtual void PrepareRootMotion(float SimulationTime, float MovementTickTime, const ACharacter& Character, const UCharacterMovementComponent& MoveComponent) override;
+
+	virtual bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) override;
+
+	virtual UScriptStruct* GetScriptStruct() const override;
+
+	virtual FString ToSimpleString() const override;
+};
+
+template<>
+struct TStructOpsTypeTraits< FRootMotionSource_ClimbTransition > : public TStructOpsTypeTraitsBase2< FRootMotionSource_ClimbTransition >
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithCopy = true
+	};
+};
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CLSSpringArmComponent.h"
+#include "GameFramework/Character.h"
+#include "CLSMovementComponent.h"
+
+void UCLSSpringArmComponent::UpdateDesiredArmLocation(bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag, float DeltaTime)
+{
+	const UCLSMovementComponent* climbMovement {GetClimbMovementComponent()};
+
+	if (!bUseClimbCamera || climbMovement == nullptr || !climbMovement->IsClimbing())
+	{
+		Super::UpdateDesiredArmLocation(bDoTrace, bDoLocationLag, bDoRotationLag, DeltaTime);
+		return;
+	}
+
+	//shorten the arm so it never goes through the wall and skip the probe against it
+	bool bAnalyticBlocked {false};
+	const float defaultArmLength {TargetArmLength};
+	TargetArmLength = GetClimbArmLength(climbMovement, bAnalyticBlocked);
+
+	Super::UpdateDesiredArmLocation(bDoTrace && bAnalyticBlocked, bDoLocationLag, bDoRotationLag, DeltaTime);
+
+	TargetArmLength = defaultArmLength;
+}
+
+float UCLSSpringArmComponent::GetClimbArmLength(const UCLSMovementComponent* ClimbMovement, bool& bOutBlocked) const
+{
+	/*
+		Climb surface is treated as a plane. Arm goes from pivot in the direction opposite to view direction,
+		if it points into the wall we cut it where it gets closer than ClimbCameraWallOffset to the plane
+	*/
+
+	bOutBlocked = false;
+
+	const FVector surfaceNormal {ClimbMovement->GetClimbSurfaceNormal()};
+	if (surfaceNormal.IsNearlyZero())
+	{
+		bOutBlocked = true;
+		return TargetArmLength;
+	}
+
+	const FVector armOrigin {GetComponentLocation() + TargetOffset};
+	const FVector armDirection {-GetTargetRotation().Vector()};
+
+	const float pivotDistanceToSurface {(float)FVector::DotProduct(armOrigin - ClimbMovement->GetClimbSurfaceLocation(), surfaceNormal) - ClimbCameraWallOffset};
+	const float armDotNormal {(float)FVector::DotProduct(armDirection, surfaceNormal)};
+
+	//camera looks away from the wall, whole arm is in front of it
+	if (armDotNormal >= 0.f && pivotDistanceToSurface > 0.f)
+	{
+		return TargetArmLength;
+	}
+
+	const float maxArmLength {armDotNormal < 0.f ? pivotDistanceToSurface / -armDotNormal : 0.f};
+
+	if (maxArmLength < FMath::Min(MinClimbArmLength, TargetArmLength))
+	{
+		bOutBlocked = true;
+		return TargetArmLength;
+	}
+
+	return FMath::Min(TargetArmLength, maxArmLength);
+}
+
+const UCLSMovementComponent* UCLSSpringArmComponent::GetClimbMovementComponent() const
+{
+	const ACharacter* characterOwner {Cast<ACharacter>(GetOwner())};
+
+	return characterOwner ? characterOwner->GetCharacterMovement<UCLSMovementComponent>() : nullptr;
+}
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/SpringArmComponent.h"
+#include "CLSSpringArmComponent.generated.h"
+
+class UCLSMovementComponent;
+
+/**
+ * Spring arm that uses climb surface of the owner while climbing.
+ * Camera is placed analytically in front of the wall, collision probe runs only when that position is blocked
+ */
+UCLASS(ClassGroup = Camera, meta = (BlueprintSpawnableComponent))
+class CLIMBINGSYSTEM_API UCLSSpringArmComponent : public USpringArmComponent
+{
+	GENERATED_BODY()
+
+protected:
+	virtual void UpdateDesiredArmLocation(bool bDoTrace, bool bDoLocationLag, bool bDoRotationLag, float DeltaTime) override;
+
+private:
+	//returns arm length that keeps the camera in front of climb surface. bOutBlocked is true if there is no such length
+	float GetClimbArmLength(const UCLSMovementComponent* ClimbMovement, bool& bOutBlocked) const;
+
+	const UCLSMovementComponent* GetClimbMovementComponent() const;
+
+private:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera: Climbing", meta = (AllowPrivateAccess = "true"))
+	bool bUseClimbCamera {true};
+
+	//Min distance between camera and climb surface
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float ClimbCameraWallOffset {20.f};
+
+	//If analytic arm length is shorter than that, regular collision probe is used instead
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera: Climbing", meta = (AllowPrivateAccess = "true", ClampMin = "0", UIMin = "0"))
+	float MinClimbArmLength {50.f};
+};
@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CLSTraceRecorder.h"
+
+#if CLS_WITH_TRACE_RECORDER
+
+#include "Engine/HitResult.h"
+#include "DrawDebugHelpers.h"
+#include "Misc/FileHelper.h"
+
+static TAutoConsoleVariable<bool> CVarRecordClimbQueries(
+	TEXT("CLS.RecordClimbQueries"),
+	true,
+	TEXT("Record climb queries into per character ring buffers"));
+
+void FClimbTraceRecorder::RecordLineTrace(EClimbQueryType Type, const FVector& Start, const FVector& End, const FHitResult& Hit)
+{
+	if (!CVarRecordClimbQueries.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	FClimbQueryRecord& record {AddRecord(Type)};
+	record.Shape = FCollisionShape::LineShape;
+	record.Start = Start;
+	record.End = End;
+	record.NumHits = Hit.bBlockingHit ? 1 : 0;
+	record.HitLocation = Hit.ImpactPoint;
+	record.HitNormal = Hit.ImpactNormal;
+}
+
+void FClimbTraceRecorder::RecordOverlap(EClimbQueryType Type, const FVector& Location, const FCollisionShape& Shape, int32 NumHits, const FVector& HitLocation, const FVector& HitNormal)
+{
+	if (!CVarRecordClimbQueries.GetValueOnGameThread())
+	{
+		return;
+	}
+
+	FClimbQueryRecord& record {AddRecord(Type)};
+	record.Shape = Shape;
+	record.Start = Location;
+	record.End = Location;
+	record.NumHits = NumHits;
+	record.HitLocation = HitLocation;
+	record.HitNormal = HitNormal;
+}
+
+FClimbQueryRecord& FClimbTraceRecorder::AddRecord(EClimbQueryType Type)
+{
+	if (Records.IsEmpty())
+	{
+		Records.SetNum(Capacity);
+	}
+
+	FClimbQueryRecord& record {Records[NextIndex]};
+	record.Frame = GFrameCounter;
+	record.Time = FPlatformTime::Seconds();
+	record.Type = Type;
+
+	NextIndex = (NextIndex + 1) % Capacity;
+	NumRecords = FMath::Min(NumRecords + 1, Capacity);
+
+	return record;
+}
+
+void FClimbTraceRecorder::Draw(const UWorld* World, float Duration) const
+{
+#if ENABLE_DRAW_DEBUG
+	ForEachRecord([World, Duration](const FClimbQueryRecord& record)
+	{
+		const FColor queryColor {record.NumHits > 0 ? FColor::Green : FColor::Red};
+
+		switch (record.Shape.ShapeType)
+		{
+		case ECollisionShape::Line:
+			DrawDebugLine(World, record.Start, record.End, queryColor, false, Duration);
+			break;
+
+		case ECollisionShape::Box:
+			DrawDebugBox(World, record.Start, record.Shape.GetExtent(), queryColor, false, Duration);
+			break;
+
+		case ECollisionShape::Sphere:
+			DrawDebugSphere(World, record.Start, record.Shape.GetSphereRadius(), 12, queryColor, false, Duration);
+			break;
+
+		case ECollisionShape::Capsule:
+			DrawDebugCapsule(World, record.Start, record.Shape.GetCapsuleHalfHeight(), record.Shape.GetCapsuleRadius(), FQuat::Identity, queryColor, false, Duration);
+			break;
+		}
+
+		if (record.NumHits > 0)
+		{
+			DrawDebugPoint(World, record.HitLocation, 10.f, FColor::Blue, false, Duration);
+			DrawDebugDirectionalArrow(World, record.HitLocation, record.HitLocation + record.HitNormal * 30.f, 10.f, FColor::Blue, false, Duration);
+		}
+	});
+#endif
+}
+
+bool FClimbTraceRecorder::ExportCsv(const FString& FilePath) const
+{
+	static const TCHAR* QueryTypeNames[] {TEXT("ContactOverlap"), TEXT("OverlapTest"), TEXT("LineTrace"), TEXT("AsyncLineTrace")};
+
+	TArray<FString> lines;
+	lines.Reserve(NumRecords + 1);
+	lines.Add(TEXT("Frame,Time,Type,Shape,StartX,StartY,StartZ,EndX,EndY,EndZ,Hits,HitX,HitY,HitZ,NormalX,NormalY,NormalZ"));
+
+	ForEachRecord([&lines](const FClimbQueryRecord& record)
+	{
+		lines.Add(FString::Printf(TEXT("%llu,%.4f,%s,%d,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%d,%.2f,%.2f,%.2f,%.3f,%.3f,%.3f"),
+			record.Frame, record.Time, QueryTypeNames[(int32)record.Type], (int32)record.Shape.ShapeType,
+			record.Start.X, record.Start.Y, record.Start.Z, record.End.X, record.End.Y, record.End.Z,
+			record.NumHits, record.HitLocation.X, record.HitLocation.Y, record.HitLocation.Z,
+			record.HitNormal.X, record.HitNormal.Y, record.HitNormal.Z));
+	});
+
+	return FFileHelper::SaveStringArrayToFile(lines, *FilePath);
+}
+
+void FClimbTraceRecorder::Reset()
+{
+	NextIndex = 0;
+	NumRecords = 0;
+}
+
+#endif
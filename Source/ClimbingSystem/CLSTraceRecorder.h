@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "CollisionShape.h"
+
+//Climb query recording is compiled out of shipping builds
+#ifndef CLS_WITH_TRACE_RECORDER
+#define CLS_WITH_TRACE_RECORDER !UE_BUILD_SHIPPING
+#endif
+
+#if CLS_WITH_TRACE_RECORDER
+
+struct FHitResult;
+
+enum class EClimbQueryType : uint8
+{
+	ContactOverlap,
+	OverlapTest,
+	LineTrace,
+	AsyncLineTrace
+};
+
+struct FClimbQueryRecord
+{
+	uint64 Frame {0};
+	double Time {0.0};
+	EClimbQueryType Type {EClimbQueryType::LineTrace};
+	FCollisionShape Shape;
+	FVector Start {FVector::ZeroVector};
+	FVector End {FVector::ZeroVector};
+	FVector HitLocation {FVector::ZeroVector};
+	FVector HitNormal {FVector::ZeroVector};
+	int32 NumHits {0};
+};
+
+/**
+ * Fixed size ring buffer of the latest climb queries of one character.
+ * Recording is a copy into preallocated memory, drawing and export happen only on demand
+ */
+class FClimbTraceRecorder
+{
+public:
+	static constexpr int32 Capacity {256};
+
+	void RecordLineTrace(EClimbQueryType Type, const FVector& Start, const FVector& End, const FHitResult& Hit);
+	void RecordOverlap(EClimbQueryType Type, const FVector& Location, const FCollisionShape& Shape, int32 NumHits, const FVector& HitLocation = FVector::ZeroVector, const FVector& HitNormal = FVector::ZeroVector);
+
+	//draws recorded queries, oldest first
+	void Draw(const UWorld* World, float Duration) const;
+
+	bool ExportCsv(const FString& FilePath) const;
+
+	void Reset();
+
+	FORCEINLINE int32 Num() const {return NumRecords;};
+
+private:
+	FClimbQueryRecord& AddRecord(EClimbQueryType Type);
+
+	template <typename FunctionType>
+	void ForEachRecord(FunctionType&& Function) const
+	{
+		const int32 firstIndex {NumRecords < Capacity ? 0 : NextIndex};
+		for (int32 i = 0; i < NumRecords; ++i)
+		{
+			Function(Records[(firstIndex + i) % Capacity]);
+		}
+	}
+
+	TArray<FClimbQueryRecord> Records;
+	int32 NextIndex {0};
+	int32 NumRecords {0};
+};
+
+#endif
@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "CLSTraversalQuerySubsystem.h"
+
+static TAutoConsoleVariable<float> CVarTraversalQueryBudgetMs(
+	TEXT("CLS.TraversalQueryBudgetMs"),
+	0.5f,
+	TEXT("Time per frame traversal query service may spend on evaluating requests"));
+
+void UCLSTraversalQuerySubsystem::RequestTraversalOptions(UCLSMovementComponent* Agent, FOnTraversalQueryCompleted Callback)
+{
+	if (!IsValid(Agent) || Agent->UpdatedComponent == nullptr)
+	{
+		Callback.ExecuteIfBound(FClimbTraversalOptions {});
+		return;
+	}
+
+	const FQueryKey key {MakeKey(Agent)};
+
+	if (const FCachedOptions* cachedOptions {CachedOptions.Find(key)})
+	{
+		if (GetWorld()->GetTimeSeconds() - cachedOptions->Time <= CacheLifetime)
+		{
+			Callback.ExecuteIfBound(cachedOptions->Options);
+			return;
+		}
+	}
+
+	FQueryBatch* batch {PendingBatches.Find(key)};
+	if (batch == nullptr)
+	{
+		batch = &PendingBatches.Add(key);
+		PendingOrder.Add(key);
+	}
+
+	batch->Requests.Add(FQueryRequest {Agent, MoveTemp(Callback)});
+}
+
+void UCLSTraversalQuerySubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	const double worldTime {GetWorld()->GetTimeSeconds()};
+	for (auto It = CachedOptions.CreateIterator(); It; ++It)
+	{
+		if (worldTime - It->Value.Time > CacheLifetime)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	//at least one batch per frame so requests never starve
+	const double budgetSeconds {CVarTraversalQueryBudgetMs.GetValueOnGameThread() / 1000.0};
+	const double startTime {FPlatformTime::Seconds()};
+
+	int32 processedBatches {0};
+	TArray<FQueryRequest> movedRequests;
+	while (processedBatches < PendingOrder.Num() && (processedBatches == 0 || FPlatformTime::Seconds() - startTime < budgetSeconds))
+	{
+		const FQueryKey key {PendingOrder[processedBatches++]};
+
+		FQueryBatch batch;
+		if (!PendingBatches.RemoveAndCopyValue(key, batch))
+		{
+			continue;
+		}
+
+		ProcessBatch(key, batch, movedRequests);
+	}
+
+	PendingOrder.RemoveAt(0, processedBatches, false);
+
+	//requeued only now so they are evaluated in a later frame and count against its budget
+	for (FQueryRequest& request : movedRequests)
+	{
+		if (UCLSMovementComponent* agent {request.Agent.Get()})
+		{
+			RequestTraversalOptions(agent, MoveTemp(request.Callback));
+		}
+	}
+}
+
+TStatId UCLSTraversalQuerySubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UCLSTraversalQuerySubsystem, STATGROUP_Tickables);
+}
+
+UCLSTraversalQuerySubsystem::FQueryKey UCLSTraversalQuerySubsystem::MakeKey(const UCLSMovementComponent* Agent) const
+{
+	const FVector location {Agent->UpdatedComponent->GetComponentLocation()};
+	const float yaw {(float)FRotator::ClampAxis(Agent->UpdatedComponent->GetComponentRotation().Yaw)};
+	const float sectorSize {360.f / NumYawSectors};
+
+	FQueryKey key;
+	key.Cell = FIntVector {FMath::FloorToInt32(location.X / CellSize), FMath::FloorToInt32(location.Y / CellSize), FMath::FloorToInt32(location.Z / CellSize)};
+	key.YawSector = FMath::RoundToInt32(yaw / sectorSize) % NumYawSectors;
+	return key;
+}
+
+void UCLSTraversalQuerySubsystem::ProcessBatch(const FQueryKey& Key, FQueryBatch& Batch, TArray<FQueryRequest>& OutMovedRequests)
+{
+	TOptional<FClimbTraversalOptions> options;
+
+	for (FQueryRequest& request : Batch.Requests)
+	{
+		UCLSMovementComponent* agent {request.Agent.Get()};
+		if (agent == nullptr || agent->UpdatedComponent == nullptr)
+		{
+			continue;
+		}
+
+		//result is only valid for agents still in batch cell and facing
+		if (!(MakeKey(agent) == Key))
+		{
+			OutMovedRequests.Add(MoveTemp(request));
+			continue;
+		}
+
+		//one evaluation answers the whole batch
+		if (!options.IsSet())
+		{
+			options = agent->EvaluateTraversalOptions();
+			CachedOptions.Add(Key, FCachedOptions {options.GetValue(), GetWorld()->GetTimeSeconds()});
+		}
+
+		request.Callback.ExecuteIfBound(options.GetValue());
+	}
+}
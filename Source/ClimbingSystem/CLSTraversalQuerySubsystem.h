@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "CLSMovementComponent.h"
+#include "CLSTraversalQuerySubsystem.generated.h"
+
+DECLARE_DELEGATE_OneParam(FOnTraversalQueryCompleted, const FClimbTraversalOptions&)
+
+/**
+ * Time-sliced traversal detection for AI.
+ * Requests are batched by quantized location and facing, evaluated once per batch under a per-frame budget,
+ * and results are cached so agents standing close together reuse them
+ */
+UCLASS()
+class CLIMBINGSYSTEM_API UCLSTraversalQuerySubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/*
+		Callback is executed when options are evaluated, or right away if a fresh cached result exists.
+		Requests of agents with the same location cell and facing share one evaluation
+	*/
+	void RequestTraversalOptions(UCLSMovementComponent* Agent, FOnTraversalQueryCompleted Callback);
+
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+private:
+	struct FQueryKey
+	{
+		FIntVector Cell;
+		int32 YawSector {0};
+
+		bool operator==(const FQueryKey& Other) const {return Cell == Other.Cell && YawSector == Other.YawSector;};
+		friend uint32 GetTypeHash(const FQueryKey& Key) {return HashCombine(GetTypeHash(Key.Cell), ::GetTypeHash(Key.YawSector));};
+	};
+
+	struct FQueryRequest
+	{
+		TWeakObjectPtr<UCLSMovementComponent> Agent;
+		FOnTraversalQueryCompleted Callback;
+	};
+
+	struct FQueryBatch
+	{
+		TArray<FQueryRequest> Requests;
+	};
+
+	struct FCachedOptions
+	{
+		FClimbTraversalOptions Options;
+		double Time {0.0};
+	};
+
+	FQueryKey MakeKey(const UCLSMovementComponent* Agent) const;
+
+	//evaluates batch with the first agent that is still in batch cell, requests of agents that moved to another key are returned to be requeued
+	void ProcessBatch(const FQueryKey& Key, FQueryBatch& Batch, TArray<FQueryRequest>& OutMovedRequests);
+
+	//Location cell size, agents closer than that share results
+	static constexpr float CellSize {50.f};
+	static constexpr int32 NumYawSectors {8};
+
+	//How long evaluated options are reused
+	static constexpr double CacheLifetime {0.5};
+
+	TMap<FQueryKey, FQueryBatch> PendingBatches;
+
+	//keeps batches in request order
+	TArray<FQueryKey> PendingOrder;
+
+	TMap<FQueryKey, FCachedOptions> CachedOptions;
+};
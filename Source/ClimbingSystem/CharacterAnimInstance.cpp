@@ -36,6 +36,28 @@ void UCharacterAnimInstance::NativeUpdateAnimation(float DeltaSeconds)
 	GetSholdMove();
 	GetIsClimbing();
 	GetClimbVelocity();
+	GetLimbIKTargets();
+}
+
+void UCharacterAnimInstance::NativeThreadSafeUpdateAnimation(float DeltaSeconds)
+{
+	Super::NativeThreadSafeUpdateAnimation(DeltaSeconds);
+
+	FClimbLimbIK* limbIKs[] {&HandLeftIK, &HandRightIK, &FootLeftIK, &FootRightIK};
+
+	for (int32 limbIndex = 0; limbIndex < UE_ARRAY_COUNT(limbIKs); ++limbIndex)
+	{
+		FClimbLimbIK& limbIK {*limbIKs[limbIndex]};
+		const bool bHasTarget {LimbIKTargetValid[limbIndex]};
+
+		//snap to the first target, follow next ones smoothly
+		if (bHasTarget)
+		{
+			limbIK.Location = limbIK.Alpha > 0.f ? FMath::VInterpTo(limbIK.Location, LimbIKTargetLocations[limbIndex], DeltaSeconds, LimbIKInterpSpeed) : LimbIKTargetLocations[limbIndex];
+		}
+
+		limbIK.Alpha = FMath::FInterpTo(limbIK.Alpha, bHasTarget ? 1.f : 0.f, DeltaSeconds, LimbIKInterpSpeed);
+	}
 }
 
 void UCharacterAnimInstance::GetGroundSpeed()
@@ -61,6 +83,7 @@ void UCharacterAnimInstance::GetIsFalling()
 void UCharacterAnimInstance::GetIsClimbing()
 {
 	bIsClimbing = PlayerMovementComponent->IsClimbing();
+	bIsHangingOnLedge = PlayerMovementComponent->IsHangingOnLedge();
 }
 
 void UCharacterAnimInstance::GetClimbVelocity()
@@ -68,3 +91,13 @@ void UCharacterAnimInstance::GetClimbVelocity()
 	ClimbVelocity = PlayerMovementComponent->GetUnrotatedClimbVelocity();
 }
 
+void UCharacterAnimInstance::GetLimbIKTargets()
+{
+	for (int32 limbIndex = 0; limbIndex < (int32)EClimbLimb::Count; ++limbIndex)
+	{
+		const FClimbLimbTarget& limbTarget {PlayerMovementComponent->GetClimbLimbTarget((EClimbLimb)limbIndex)};
+		LimbIKTargetValid[limbIndex] = limbTarget.bValid;
+		LimbIKTargetLocations[limbIndex] = limbTarget.Location;
+	}
+}
+
@@ -4,10 +4,23 @@
 
 #include "CoreMinimal.h"
 #include "Animation/AnimInstance.h"
+#include "CLSMovementComponent.h"
 #include "CharacterAnimInstance.generated.h"
 
 class AClimbingSystemCharacter;
-class UCLSMovementComponent;
+
+//Limb IK target in world space, blended in and out by Alpha
+USTRUCT(BlueprintType)
+struct FClimbLimbIK
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Character Movement: Climbing")
+	FVector Location {FVector::ZeroVector};
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Character Movement: Climbing")
+	float Alpha {0.f};
+};
 
 UCLASS()
 class CLIMBINGSYSTEM_API UCharacterAnimInstance : public UAnimInstance
@@ -18,6 +31,7 @@ public:
 
 	virtual void NativeInitializeAnimation() override;
 	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
+	virtual void NativeThreadSafeUpdateAnimation(float DeltaSeconds) override;
 
 private:
 	AClimbingSystemCharacter* PlayerCharacter;
@@ -38,9 +52,32 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
 	bool bIsClimbing;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	bool bIsHangingOnLedge;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
 	FVector ClimbVelocity;
 
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	FClimbLimbIK HandLeftIK;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	FClimbLimbIK HandRightIK;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	FClimbLimbIK FootLeftIK;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	FClimbLimbIK FootRightIK;
+
+	//How fast limb IK blends in and out
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, category = "Character Movement: Climbing", meta = (AllowPrivateAccess = "true"))
+	float LimbIKInterpSpeed {10.f};
+
+	//limb probe results copied on game thread, consumed in thread safe update
+	FVector LimbIKTargetLocations[(int32)EClimbLimb::Count];
+	bool LimbIKTargetValid[(int32)EClimbLimb::Count] {};
+
 private:
 	void GetGroundSpeed();
 	void GetAirSpeedSpeed();
@@ -48,4 +85,5 @@ private:
 	void GetIsFalling();
 	void GetIsClimbing();
 	void GetClimbVelocity();
+	void GetLimbIKTargets();
 };
@@ -9,5 +9,7 @@ public class ClimbingSystem : ModuleRules
 		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
 
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore", "HeadMountedDisplay", "EnhancedInput", "MotionWarping" });
+
+		PrivateDependencyModuleNames.AddRange(new string[] { "Json" });
 	}
 }
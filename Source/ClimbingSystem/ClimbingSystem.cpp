@@ -3,5 +3,7 @@
 #include "ClimbingSystem.h"
 #include "Modules/ModuleManager.h"
 
+DEFINE_LOG_CATEGORY(LogClimbingSystem);
+
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, ClimbingSystem, "ClimbingSystem" );
  
\ No newline at end of file
@@ -3,3 +3,8 @@
 #pragma once
 
 #include "CoreMinimal.h"
+
+CLIMBINGSYSTEM_API DECLARE_LOG_CATEGORY_EXTERN(LogClimbingSystem, Log, All);
+
+//Trace channel that climbable geometry blocks. Configured in DefaultEngine.ini
+#define ECC_Climbable ECC_GameTraceChannel1
@@ -5,7 +5,7 @@
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/Controller.h"
-#include "GameFramework/SpringArmComponent.h"
+#include "CLSSpringArmComponent.h"
 #include "EnhancedInputComponent.h"
 #include "EnhancedInputSubsystems.h"
 #include "CLSMovementComponent.h"
@@ -20,20 +20,20 @@ void AClimbingSystemCharacter::OnMovementModeChanged(EMovementMode PrevMovementM
 {
 	Super::OnMovementModeChanged(PrevMovementMode,PreviousCustomMode);
 
+	//capsule is resized over several frames to avoid overlap updates and penetration hitches on transitions
 	if (CLSMovementComponent->IsClimbing())
 	{
-		GetCapsuleComponent()->SetCapsuleHalfHeight(48.f);
+		CLSMovementComponent->BeginCapsuleMorph(48.f);
 	}
 
 	//if we exiting climbing
 	else if (!CLSMovementComponent->IsClimbing() && PrevMovementMode == MOVE_Custom && PreviousCustomMode == (uint8)ECustomMovementMode::MOVE_Climb)
 	{
-		GetCapsuleComponent()->SetCapsuleHalfHeight(96.f);
-
 		//restore vertical position of character in case we exited climbing at angle
 		const FRotator exitClimbRotation {GetActorRotation()};
 		const FRotator desiredRotation {0.f,exitClimbRotation.Yaw, exitClimbRotation.Roll};
-		SetActorRotation(desiredRotation);
+
+		CLSMovementComponent->BeginCapsuleMorph(96.f, desiredRotation.Quaternion());
 	}
 }
 
@@ -62,7 +62,7 @@ AClimbingSystemCharacter::AClimbingSystemCharacter(const FObjectInitializer& Obj
 	GetCharacterMovement()->BrakingDecelerationWalking = 2000.f;
 
 	// Create a camera boom (pulls in towards the player if there is a collision)
-	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
+	CameraBoom = CreateDefaultSubobject<UCLSSpringArmComponent>(TEXT("CameraBoom"));
 	CameraBoom->SetupAttachment(RootComponent);
 	CameraBoom->TargetArmLength = 400.0f; // The camera follows at this distance behind the character	
 	CameraBoom->bUsePawnControlRotation = true; // Rotate the arm based on the controller
@@ -79,17 +79,10 @@ void AClimbingSystemCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 
-	//Add Input Mapping Context
-	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
-	{
-		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
-		{
-			Subsystem->AddMappingContext(DefaultMappingContext, 0);
-		}
-	}
-
-	CLSMovementComponent->OnEnterClimbStateDelegate.BindUObject(this,&ThisClass::OnPlayerEnteredClimbState);
-	CLSMovementComponent->OnExitClimbStateDelegate.BindUObject(this,&ThisClass::OnPlayerExitedClimbState);
+	//Add Input Mapping Contexts once. Rebuilding mappings on every climb transition is expensive,
+	//so climbing context wins keys shared with default one and its handlers route input by climbing state
+	AddInputMappingContext(DefaultMappingContext, 0);
+	AddInputMappingContext(ClimbingMappingContext, 1);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -105,8 +98,8 @@ void AClimbingSystemCharacter::SetupPlayerInputComponent(class UInputComponent*
 		EnhancedInputComponent->BindAction(JumpAction, ETriggerEvent::Completed, this, &ACharacter::StopJumping);
 
 		//Moving
-		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &ThisClass::GroundMovement);
-		EnhancedInputComponent->BindAction(ClimbMoveAction, ETriggerEvent::Triggered, this, &ThisClass::ClimbingMovement);
+		EnhancedInputComponent->BindAction(MoveAction, ETriggerEvent::Triggered, this, &ThisClass::OnMoveInput);
+		EnhancedInputComponent->BindAction(ClimbMoveAction, ETriggerEvent::Triggered, this, &ThisClass::OnMoveInput);
 
 		//Looking
 		EnhancedInputComponent->BindAction(LookAction, ETriggerEvent::Triggered, this, &ThisClass::Look);
@@ -116,10 +109,23 @@ void AClimbingSystemCharacter::SetupPlayerInputComponent(class UInputComponent*
 
 		//Climbing
 		EnhancedInputComponent->BindAction(ClimbHopAction, ETriggerEvent::Started, this, &ThisClass::OnHopActionStarted);
+		EnhancedInputComponent->BindAction(ClimbHopAction, ETriggerEvent::Completed, this, &ThisClass::OnHopActionCompleted);
 	}
 
 }
 
+void AClimbingSystemCharacter::OnMoveInput(const FInputActionValue& Value)
+{
+	if (CLSMovementComponent->IsClimbing())
+	{
+		ClimbingMovement(Value);
+	}
+	else
+	{
+		GroundMovement(Value);
+	}
+}
+
 void AClimbingSystemCharacter::GroundMovement(const FInputActionValue& Value)
 {
 	// input is a Vector2D
@@ -180,12 +186,19 @@ void AClimbingSystemCharacter::OnClimbActionStarted(const FInputActionValue& Val
 
 void AClimbingSystemCharacter::OnHopActionStarted(const FInputActionValue& Value)
 {
+	//climbing context is always registered and consumes jump keys, so hop jumps while not climbing
+	if (!CLSMovementComponent->IsClimbing())
+	{
+		Jump();
+		return;
+	}
+
 	Debug::Print("Hop action");
 }
 
-void AClimbingSystemCharacter::OnPlayerEnteredClimbState()
+void AClimbingSystemCharacter::OnHopActionCompleted(const FInputActionValue& Value)
 {
-	AddInputMappingContext(ClimbingMappingContext,1);
+	StopJumping();
 }
 
 void AClimbingSystemCharacter::AddInputMappingContext(UInputMappingContext* NewContext, int32 Priority)
@@ -199,19 +212,3 @@ void AClimbingSystemCharacter::AddInputMappingContext(UInputMappingContext* NewC
 	}
 }
 
-void AClimbingSystemCharacter::OnPlayerExitedClimbState()
-{
-	RemoveInputMappingContext(ClimbingMappingContext);
-}
-
-void AClimbingSystemCharacter::RemoveInputMappingContext(UInputMappingContext* Context)
-{
-	if (APlayerController* PlayerController = Cast<APlayerController>(Controller))
-	{
-		if (UEnhancedInputLocalPlayerSubsystem* Subsystem = ULocalPlayer::GetSubsystem<UEnhancedInputLocalPlayerSubsystem>(PlayerController->GetLocalPlayer()))
-		{
-			Subsystem->RemoveMappingContext(Context);
-		}
-	}
-}
-
@@ -44,7 +44,9 @@ protected:
 	virtual void BeginPlay();
 
 private:
-	/** Called for movement input */
+	/** Called for movement input of both contexts, routes it by climbing state */
+	void OnMoveInput(const FInputActionValue& Value);
+
 	void GroundMovement(const FInputActionValue& Value);
 	void ClimbingMovement(const FInputActionValue& Value);
 
@@ -54,16 +56,11 @@ private:
 	/** Called when activate climbing from input */
 	void OnClimbActionStarted(const FInputActionValue& Value);
 
-	/** Called when activate hop from input */
+	/** Called when activate hop from input. Hop shares keys with jump, so it jumps while not climbing */
 	void OnHopActionStarted(const FInputActionValue& Value);
-
-	//Callbacks//
-
-	void OnPlayerEnteredClimbState();
-	void OnPlayerExitedClimbState();
+	void OnHopActionCompleted(const FInputActionValue& Value);
 
 	void AddInputMappingContext(UInputMappingContext* NewContext, int32 Priority);
-	void RemoveInputMappingContext(UInputMappingContext* NewContext);
 
 private:
 